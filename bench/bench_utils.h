@@ -0,0 +1,153 @@
+#pragma once
+
+// shared by the benchmark executables: timing passes, ns/op statistics over the passes, the JSON report and
+// replaying a loaded recording
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Snapshot.h"
+
+/** @brief keep the compiler from discarding a result that is never used */
+template <typename T>
+inline void do_not_optimize(const T &value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct BenchmarkResult
+{
+    std::string name;
+    std::string kind; // groups results, e.g. "strategy" for a whole mapping and "stage" for a part of one
+    size_t ops = 0;   // calls per repetition
+    size_t ok = 0;    // calls that succeeded, per repetition
+    // over the repetitions' ns/op, each one a whole pass's mean, not a per call distribution
+    double min_ns = 0;
+    double median_ns = 0;
+    double max_ns = 0;
+    double mean_ns = 0;
+};
+
+struct BenchmarkConfig
+{
+    uint32_t warmup;
+    uint32_t repetitions;
+};
+
+/**
+ * @brief time `repetitions` passes of `pass` after `warmup` untimed ones
+ * @param pass runs all `ops` calls and returns how many succeeded
+ * a whole pass is timed, so the clock overhead is amortized over `ops` calls, and its ns/op is one sample.
+ * the samples are pass means, a slow call only shows up as far as it moves its pass, so there are no tail percentiles.
+ */
+template <typename Pass>
+BenchmarkResult run_benchmark(const BenchmarkConfig &config, std::string name, std::string kind, size_t ops, Pass pass)
+{
+    BenchmarkResult result{std::move(name), std::move(kind), ops};
+    if (ops == 0)
+    {
+        return result;
+    }
+
+    for (uint32_t i = 0; i < config.warmup; i++)
+    {
+        pass();
+    }
+
+    std::vector<double> samples;
+    samples.reserve(config.repetitions);
+    for (uint32_t i = 0; i < config.repetitions; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        result.ok = pass();
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(end - start).count() / ops);
+    }
+
+    std::ranges::sort(samples);
+    result.min_ns = samples.front();
+    result.median_ns = samples[(samples.size() - 1) / 2];
+    result.max_ns = samples.back();
+    for (auto sample : samples)
+    {
+        result.mean_ns += sample / samples.size();
+    }
+    return result;
+}
+
+inline std::string escape_json(std::string_view text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+/** @brief the JSON array of `results` */
+inline std::string benchmarks_json(const std::vector<BenchmarkResult> &results)
+{
+    std::string json = "[";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const auto &result = results[i];
+        json += std::format("{}\n    {{\"name\": \"{}\", \"kind\": \"{}\", \"ops\": {}, \"ok\": {}, "
+                            "\"ns_per_op\": {{\"min\": {:.2f}, \"median\": {:.2f}, \"max\": {:.2f}, \"mean\": {:.2f}}}}}",
+            i == 0 ? "" : ",", escape_json(result.name), result.kind, result.ops, result.ok,
+            result.min_ns, result.median_ns, result.max_ns, result.mean_ns);
+    }
+    return json + "\n  ]";
+}
+
+/** @brief print the report to stdout, or write it to `output_path` if given */
+inline bool write_report(const std::string &json, const std::string &output_path)
+{
+    if (output_path.empty())
+    {
+        printf("%s", json.c_str());
+        return true;
+    }
+
+    std::ofstream output(output_path);
+    output << json;
+    if (!output)
+    {
+        printf("Failed to write %s\n", output_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+/** @brief replays snapshots from memory in a loop, e.g. a loaded recording */
+class MemorySource
+{
+public:
+    explicit MemorySource(std::span<const Snapshot> snapshots) : snapshots(snapshots) {}
+
+    Snapshot get()
+    {
+        if (snapshots.empty())
+        {
+            return Snapshot::invalid();
+        }
+        const auto &snapshot = snapshots[next];
+        next = next + 1 == snapshots.size() ? 0 : next + 1;
+        return snapshot;
+    }
+
+private:
+    std::span<const Snapshot> snapshots;
+    size_t next = 0;
+};
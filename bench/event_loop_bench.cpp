@@ -0,0 +1,248 @@
+// the guns on threads (`GunSet`, 2 threads per gun) against the guns as tasks on one epoll event loop
+// (`AsyncGunSet`), for 1 to `GunSet::max_guns` guns, reported as JSON. 2 kinds of sources:
+// - loopback: the recording replayed from memory at --fps, `source_wakeup` is how late the pacing wakes up after
+//   a frame's deadline (a sleep on the threads, the shared timerfd on the loop)
+// - idle: bound UDP sockets nobody sends to, the CPU it takes to wait
+// a consumer picks the frames up like the render loop (a 1 ms wait on the threads, the frame signal or a 10 ms
+// input poll on the loop), `pickup` is the latency from acquisition to the consumer. `cpu_percent` is the CPU time
+// of the whole process over the wall time.
+// usage: event_loop_bench raw_data.txt --fps 60 --seconds 3 --output event_loop.json
+
+#include <CLI/CLI.hpp>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <format>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AsyncGunSet.h"
+#include "DataAcqUDP.h"
+#include "EventLoop.h"
+#include "FramePacer.h"
+#include "GunSet.h"
+#include "IAsyncDataAcq.h"
+#include "IDataAcq.h"
+#include "LatencyHistogram.h"
+#include "Recording.h"
+#include "bench_utils.h"
+
+namespace
+{
+
+class LoopbackSource : public IDataAcq, public IAsyncDataAcq
+{
+public:
+    LoopbackSource(std::span<const Snapshot> snapshots, uint32_t fps, LatencyHistogram &wakeup)
+        : source(snapshots), pacer(std::chrono::nanoseconds(std::chrono::seconds(1)) / fps), wakeup(wakeup)
+    {
+    }
+
+    Snapshot get() override
+    {
+        auto deadline = pacer.wait_next();
+        wakeup.record(EventLoop::clock::now() - deadline);
+        return source.get();
+    }
+
+    Task<Snapshot> get_async(EventLoop &loop) override
+    {
+        auto deadline = pacer.schedule_next();
+        co_await loop.sleep_until(deadline);
+        pacer.tick(deadline);
+        wakeup.record(EventLoop::clock::now() - deadline);
+        co_return source.get();
+    }
+
+private:
+    MemorySource source;
+    FramePacer pacer;
+    LatencyHistogram &wakeup;
+};
+
+std::chrono::nanoseconds process_cpu_time()
+{
+    timespec time{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+    return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+}
+
+struct Run
+{
+    double seconds = 0;
+    double cpu_seconds = 0;
+    uint64_t picked = 0;
+    LatencyHistogram pickup;
+    uint64_t loop_wakeups = 0;
+};
+
+// the consumer side of `play`, polling with a 1 ms wait
+void run_threads(std::span<IDataAcq *const> sources, double seconds, Run &run)
+{
+    GunSet::Params params;
+    GunSet guns(sources, params);
+    const auto start = EventLoop::clock::now();
+    const auto cpu_start = process_cpu_time();
+    const auto end = start + std::chrono::duration_cast<EventLoop::clock::duration>(std::chrono::duration<double>(seconds));
+    while (EventLoop::clock::now() < end)
+    {
+        if (!guns.update())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        const auto now = EventLoop::clock::now();
+        for (size_t gun = 0; gun < guns.size(); gun++)
+        {
+            if (guns.fresh(gun))
+            {
+                run.pickup.record(now - guns.frame(gun).capture_time);
+                run.picked++;
+            }
+        }
+    }
+    run.cpu_seconds = std::chrono::duration<double>(process_cpu_time() - cpu_start).count();
+    run.seconds = std::chrono::duration<double>(EventLoop::clock::now() - start).count();
+    guns.stop();
+}
+
+// the consumer side of `render_task`, woken by the frame signal or the 10 ms input poll
+Task<void> consume(EventLoop &loop, AsyncGunSet &guns, EventLoop::clock::time_point end, Run &run)
+{
+    constexpr auto input_poll_interval = std::chrono::milliseconds(10);
+    while (EventLoop::clock::now() < end)
+    {
+        if (guns.update())
+        {
+            const auto now = EventLoop::clock::now();
+            for (size_t gun = 0; gun < guns.size(); gun++)
+            {
+                if (guns.fresh(gun))
+                {
+                    run.pickup.record(now - guns.frame(gun).capture_time);
+                    run.picked++;
+                }
+            }
+        }
+        co_await guns.frame_ready().wait_until(std::min(EventLoop::clock::now() + input_poll_interval, end));
+    }
+    loop.stop();
+}
+
+void run_event_loop(std::span<IAsyncDataAcq *const> sources, double seconds, Run &run)
+{
+    EventLoop loop;
+    GunSet::Params params;
+    AsyncGunSet guns(loop, sources, params);
+    const auto start = EventLoop::clock::now();
+    const auto cpu_start = process_cpu_time();
+    loop.spawn(consume(loop, guns, start + std::chrono::duration_cast<EventLoop::clock::duration>(std::chrono::duration<double>(seconds)), run));
+    loop.run();
+    run.cpu_seconds = std::chrono::duration<double>(process_cpu_time() - cpu_start).count();
+    run.seconds = std::chrono::duration<double>(EventLoop::clock::now() - start).count();
+    run.loop_wakeups = loop.stats().wakeups;
+}
+
+std::string percentiles_json(const LatencyHistogram::Counts &counts)
+{
+    return std::format("{{\"p50_ms\": {:.3f}, \"p99_ms\": {:.3f}, \"max_ms\": {:.3f}}}",
+        counts.percentile_ms(0.5), counts.percentile_ms(0.99), counts.max_ms());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CLI::App app{"Lightgun threads against event loop benchmarks"};
+
+    std::string recording_path = "raw_data.txt";
+    app.add_option("recording", recording_path, "Text or binary recording the loopback guns replay")
+        ->check(CLI::ExistingFile)
+        ->capture_default_str();
+
+    uint32_t fps = 60;
+    app.add_option("--fps", fps, "Snapshots per second of every loopback gun")
+        ->check(CLI::Range(1u, 100000u))
+        ->capture_default_str();
+
+    double seconds = 3;
+    app.add_option("--seconds", seconds, "Run time per mode, kind of source and number of guns")
+        ->check(CLI::Range(0.1, 600.0))
+        ->capture_default_str();
+
+    size_t max_guns = GunSet::max_guns;
+    app.add_option("--max-guns", max_guns, "Measure 1 up to this many guns")
+        ->check(CLI::Range(size_t{1}, GunSet::max_guns))
+        ->capture_default_str();
+
+    std::string output_path;
+    app.add_option("-o,--output", output_path, "Write the JSON report to this file instead of stdout");
+
+    CLI11_PARSE(app, argc, argv);
+
+    auto snapshots = Recording::load_snapshots(recording_path);
+    if (!snapshots.has_value() || snapshots->empty())
+    {
+        printf("Error: no snapshots in %s\n", recording_path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::string runs_json;
+    for (const char *kind : {"loopback", "idle"})
+    {
+        const bool idle = std::string_view(kind) == "idle";
+        for (size_t gun_count = 1; gun_count <= max_guns; gun_count++)
+        {
+            for (const char *mode : {"threads", "event_loop"})
+            {
+                LatencyHistogram wakeup;
+                std::vector<std::unique_ptr<LoopbackSource>> loopbacks;
+                std::vector<std::unique_ptr<DataAcqUDP>> sockets;
+                std::vector<IDataAcq *> sources;
+                std::vector<IAsyncDataAcq *> async_sources;
+                for (size_t gun = 0; gun < gun_count; gun++)
+                {
+                    if (idle)
+                    {
+                        // port 0 binds any free port
+                        sockets.push_back(std::make_unique<DataAcqUDP>(0));
+                        if (!sockets.back()->is_open())
+                        {
+                            return EXIT_FAILURE;
+                        }
+                        sources.push_back(sockets.back().get());
+                        async_sources.push_back(sockets.back().get());
+                    }
+                    else
+                    {
+                        loopbacks.push_back(std::make_unique<LoopbackSource>(snapshots.value(), fps, wakeup));
+                        sources.push_back(loopbacks.back().get());
+                        async_sources.push_back(loopbacks.back().get());
+                    }
+                }
+
+                Run run;
+                if (std::string_view(mode) == "threads")
+                {
+                    run_threads(sources, seconds, run);
+                }
+                else
+                {
+                    run_event_loop(async_sources, seconds, run);
+                }
+
+                runs_json += std::format("{}\n    {{\"sources\": \"{}\", \"mode\": \"{}\", \"guns\": {}, \"cpu_percent\": {:.2f}, "
+                                         "\"picked_fps\": {:.1f}, \"loop_wakeups_per_s\": {:.1f}, \"source_wakeup\": {}, \"pickup\": {}}}",
+                    runs_json.empty() ? "" : ",", kind, mode, gun_count, 100 * run.cpu_seconds / run.seconds,
+                    run.picked / run.seconds, run.loop_wakeups / run.seconds,
+                    percentiles_json(wakeup.counts()), percentiles_json(run.pickup.counts()));
+            }
+        }
+    }
+
+    std::string json = std::format("{{\n  \"recording\": \"{}\",\n  \"fps\": {},\n  \"hardware_threads\": {},\n  \"runs\": [{}\n  ]\n}}\n",
+        escape_json(recording_path), fps, std::thread::hardware_concurrency(), runs_json);
+    return write_report(json, output_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
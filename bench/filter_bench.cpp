@@ -0,0 +1,225 @@
+// replays a recording through the cursor filters and reports jitter reduction against added lag, as JSON.
+// jitter is the RMS of the cursor's second difference (noise dominates it, steady motion doesn't),
+// lag is the delay that best aligns the filtered cursor with the raw one.
+// usage: filter_bench raw_data.txt --fps 15 --output filters.json
+
+#include <CLI/CLI.hpp>
+#include <cmath>
+#include <cstdio>
+#include <format>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "CursorFilter.h"
+#include "LinAlgPointMapping.h"
+#include "Recording.h"
+#include "bench_utils.h"
+
+namespace
+{
+
+struct Sample
+{
+    std::chrono::nanoseconds time;
+    PointF cursor;
+    bool starts_run; // the previous frame wasn't mapped
+};
+
+struct FilterConfig
+{
+    std::string name;
+    std::string params;
+    std::function<std::unique_ptr<ICursorFilter>()> make; // nullptr for the unfiltered baseline
+};
+
+// RMS of the second difference over runs of consecutive mapped frames
+double jitter(const std::vector<Sample> &samples, const std::vector<PointF> &cursors)
+{
+    double sum = 0;
+    size_t count = 0;
+    for (size_t i = 2; i < samples.size(); i++)
+    {
+        if (samples[i].starts_run || samples[i - 1].starts_run)
+        {
+            continue;
+        }
+        double ax = cursors[i].x - 2 * cursors[i - 1].x + cursors[i - 2].x;
+        double ay = cursors[i].y - 2 * cursors[i - 1].y + cursors[i - 2].y;
+        sum += ax * ax + ay * ay;
+        count++;
+    }
+    return count ? std::sqrt(sum / count) : 0;
+}
+
+// the delay (in whole ms) of `cursors` behind the raw samples, by least squares against the interpolated raw path
+double lag_ms(const std::vector<Sample> &samples, const std::vector<PointF> &cursors)
+{
+    double best_lag = 0;
+    double best_error = INFINITY;
+    for (int lag = 0; lag <= 200; lag++)
+    {
+        const auto delay = std::chrono::milliseconds(lag);
+        double error = 0;
+        size_t count = 0;
+        size_t run_start = 0;
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            if (samples[i].starts_run)
+            {
+                run_start = i;
+            }
+            // find the raw segment around `time - delay` within the run
+            auto time = samples[i].time - delay;
+            size_t j = i;
+            while (j > run_start && samples[j].time > time)
+            {
+                j--;
+            }
+            if (samples[j].time > time)
+            {
+                // before the start of the run
+                continue;
+            }
+            float x = samples[j].cursor.x;
+            float y = samples[j].cursor.y;
+            if (j < i)
+            {
+                float t = std::chrono::duration<float>(time - samples[j].time).count() /
+                          std::chrono::duration<float>(samples[j + 1].time - samples[j].time).count();
+                x += t * (samples[j + 1].cursor.x - x);
+                y += t * (samples[j + 1].cursor.y - y);
+            }
+            error += (cursors[i].x - x) * (cursors[i].x - x) + (cursors[i].y - y) * (cursors[i].y - y);
+            count++;
+        }
+        if (count > 0 && error / count < best_error)
+        {
+            best_error = error / count;
+            best_lag = lag;
+        }
+    }
+    return best_lag;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CLI::App app{"Lightgun cursor filter benchmarks"};
+
+    std::string recording_path = "raw_data.txt";
+    app.add_option("recording", recording_path, "Text or binary recording to replay")
+        ->check(CLI::ExistingFile)
+        ->capture_default_str();
+
+    uint32_t fps = 15;
+    app.add_option("--fps", fps, "Frame rate the recording was captured at")
+        ->check(CLI::Range(1, 10000))
+        ->capture_default_str();
+
+    BenchmarkConfig config{5, 50};
+    app.add_option("--repetitions", config.repetitions, "Timed passes for the filter cost")
+        ->check(CLI::Range(1u, 1000000u))
+        ->capture_default_str();
+
+    std::string output_path;
+    app.add_option("-o,--output", output_path, "Write the JSON report to this file instead of stdout");
+
+    CLI11_PARSE(app, argc, argv);
+
+    auto snapshots = Recording::load_snapshots(recording_path);
+    if (!snapshots.has_value() || snapshots->empty())
+    {
+        printf("Error: no snapshots in %s\n", recording_path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // the unfiltered cursor of every mapped frame, frames are `1 / fps` apart
+    const ScreenCorners screen(1920, 1080);
+    const auto period = std::chrono::nanoseconds(std::chrono::seconds(1)) / fps;
+    std::vector<Sample> samples;
+    bool previous_mapped = false;
+    for (size_t i = 0; i < snapshots->size(); i++)
+    {
+        auto cursor = LinAlgPointMapping::map_snapshot_to_cursor(snapshots.value()[i], screen);
+        if (cursor.has_value())
+        {
+            samples.push_back({static_cast<int64_t>(i) * period, cursor.value(), !previous_mapped});
+        }
+        previous_mapped = cursor.has_value();
+    }
+    if (samples.size() < 3)
+    {
+        printf("Error: too few mapped frames in %s\n", recording_path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::vector<FilterConfig> configs{{"none", "", nullptr}};
+    for (float min_cutoff : {0.5f, 1.0f, 2.0f, 4.0f})
+    {
+        for (float beta : {0.005f, 0.02f, 0.05f})
+        {
+            OneEuroFilter::Params params{min_cutoff, beta, 1.0f};
+            configs.push_back({"one_euro", std::format("min_cutoff_hz={} beta={}", min_cutoff, beta),
+                               [params]() { return std::make_unique<OneEuroFilter>(params); }});
+        }
+    }
+    for (float process_noise : {1e4f, 1e5f, 1e6f})
+    {
+        for (float measurement_noise : {4.0f, 16.0f, 64.0f})
+        {
+            KalmanFilter::Params params{process_noise, measurement_noise};
+            configs.push_back({"kalman", std::format("process_noise={} measurement_noise={}", process_noise, measurement_noise),
+                               [params]() { return std::make_unique<KalmanFilter>(params); }});
+        }
+    }
+
+    std::vector<PointF> raw(samples.size());
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        raw[i] = samples[i].cursor;
+    }
+    const double raw_jitter = jitter(samples, raw);
+
+    std::string filters_json;
+    std::vector<BenchmarkResult> costs;
+    std::vector<PointF> filtered(samples.size());
+    for (const auto &filter_config : configs)
+    {
+        std::unique_ptr<ICursorFilter> filter = filter_config.make ? filter_config.make() : nullptr;
+        auto filter_pass = [&]() {
+            if (filter)
+            {
+                filter->reset();
+            }
+            for (size_t i = 0; i < samples.size(); i++)
+            {
+                filtered[i] = filter ? filter->filter(samples[i].cursor, samples[i].time) : samples[i].cursor;
+            }
+            do_not_optimize(filtered.back());
+            return samples.size();
+        };
+        filter_pass();
+
+        double filtered_jitter = jitter(samples, filtered);
+        double mean_offset = 0;
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            mean_offset += std::hypot(filtered[i].x - raw[i].x, filtered[i].y - raw[i].y) / samples.size();
+        }
+        filters_json += std::format("{}\n    {{\"filter\": \"{}\", \"params\": \"{}\", \"jitter_px\": {:.3f}, \"jitter_reduction\": {:.4f}, "
+                                    "\"lag_ms\": {:.0f}, \"mean_offset_px\": {:.3f}}}",
+            filters_json.empty() ? "" : ",", filter_config.name, filter_config.params, filtered_jitter,
+            raw_jitter > 0 ? 1 - filtered_jitter / raw_jitter : 0, lag_ms(samples, filtered), mean_offset);
+
+        costs.push_back(run_benchmark(config, filter_config.name + " " + filter_config.params, "filter", samples.size(), filter_pass));
+    }
+
+    std::string json = std::format("{{\n  \"recording\": \"{}\",\n  \"fps\": {},\n  \"mapped_frames\": {},\n  \"raw_jitter_px\": {:.3f},\n"
+                                   "  \"filters\": [{}\n  ],\n  \"benchmarks\": {}\n}}\n",
+        escape_json(recording_path), fps, samples.size(), raw_jitter, filters_json, benchmarks_json(costs));
+    return write_report(json, output_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,68 @@
+// request rate of DataAcqHTTP per pipeline depth, against the loopback ESP32 stand-in, reported as JSON.
+// `get_ms` is the time a `get()` blocks, `connections` the connections opened over the run (one per slot while
+// they are kept alive), `duplicates` the responses repeating the previous snapshot (polled faster than the camera).
+// usage: esp_http_standin raw_data.txt --port 8080 --camera-fps 30 --latency-ms 5 &
+//        http_bench --esp-address 127.0.0.1:8080 --seconds 3 --output http.json
+
+#include <CLI/CLI.hpp>
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DataAcqHTTP.h"
+#include "LatencyHistogram.h"
+#include "bench_utils.h"
+
+int main(int argc, char** argv)
+{
+    CLI::App app{"Lightgun HTTP acquisition benchmarks"};
+
+    std::string esp_address = "127.0.0.1:8080";
+    app.add_option("--esp-address", esp_address, "Address of the ESP32 or of tools/esp_http_standin.cpp")
+        ->capture_default_str();
+
+    std::vector<size_t> depths{1, 2, 4, 8};
+    app.add_option("--depths", depths, "Pipeline depths to measure")
+        ->check(CLI::Range(1, 16))
+        ->capture_default_str();
+
+    double seconds = 3;
+    app.add_option("--seconds", seconds, "Run time per pipeline depth")
+        ->check(CLI::Range(0.1, 600.0))
+        ->capture_default_str();
+
+    std::string output_path;
+    app.add_option("-o,--output", output_path, "Write the JSON report to this file instead of stdout");
+
+    CLI11_PARSE(app, argc, argv);
+
+    std::string runs_json;
+    for (size_t depth : depths)
+    {
+        DataAcqHTTP http(esp_address, depth);
+        LatencyHistogram get_time;
+        const auto start = std::chrono::steady_clock::now();
+        const auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+        while (std::chrono::steady_clock::now() < end)
+        {
+            const auto before = std::chrono::steady_clock::now();
+            do_not_optimize(http.get());
+            get_time.record(std::chrono::steady_clock::now() - before);
+        }
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const auto stats = http.stats();
+        const auto counts = get_time.counts();
+        runs_json += std::format("{}\n    {{\"depth\": {}, \"requests_per_s\": {:.1f}, \"responses\": {}, \"failures\": {}, \"duplicates\": {}, "
+                                 "\"connections\": {}, \"get_ms\": {{\"p50\": {:.3f}, \"p99\": {:.3f}, \"max\": {:.3f}}}}}",
+            runs_json.empty() ? "" : ",", depth, counts.count / elapsed, stats.responses, stats.failures, stats.duplicates,
+            stats.connections, counts.percentile_ms(0.5), counts.percentile_ms(0.99), counts.max_ms());
+    }
+
+    std::string json = std::format("{{\n  \"esp_address\": \"{}\",\n  \"seconds\": {},\n  \"hardware_threads\": {},\n  \"runs\": [{}\n  ]\n}}\n",
+        escape_json(esp_address), seconds, std::thread::hardware_concurrency(), runs_json);
+    return write_report(json, output_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,204 @@
+// micro benchmarks of the mapping pipeline, per strategy and per stage, reported as JSON.
+// snapshots are preloaded so no acquisition or pacing is timed, and every call is timed, including the failed ones.
+// usage: lightgun_bench raw_data.txt --repetitions 50 --output bench.json
+
+#include <CLI/CLI.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CachedPerspectiveMapper.h"
+#include "LinAlgPointMapping.h"
+#include "PointMapping.h"
+#include "Recording.h"
+#include "Snapshot.h"
+#include "mapping_common.h"
+#include "bench_utils.h"
+
+int main(int argc, char** argv)
+{
+    CLI::App app{"Lightgun mapping benchmarks"};
+
+    std::string recording_path = "raw_data.txt";
+    app.add_option("recording", recording_path, "Text or binary recording to benchmark on")
+        ->check(CLI::ExistingFile)
+        ->capture_default_str();
+
+    BenchmarkConfig config{5, 50};
+    app.add_option("--warmup", config.warmup, "Untimed passes over the recording before measuring")->capture_default_str();
+    app.add_option("--repetitions", config.repetitions, "Timed passes over the recording, each is one ns/op sample")
+        ->check(CLI::Range(1u, 1000000u))
+        ->capture_default_str();
+
+    std::string filter;
+    app.add_option("--filter", filter, "Only run benchmarks whose name contains this string");
+
+    std::string output_path;
+    app.add_option("-o,--output", output_path, "Write the JSON report to this file instead of stdout");
+
+    CLI11_PARSE(app, argc, argv);
+
+    auto loaded = Recording::load_snapshots(recording_path);
+    if (!loaded.has_value() || loaded->empty())
+    {
+        printf("Error: no snapshots in %s\n", recording_path.c_str());
+        return EXIT_FAILURE;
+    }
+    const auto &snapshots = loaded.value();
+    const ScreenCorners screen(1920, 1080);
+
+    // inputs of the later stages, prepared untimed
+    std::vector<std::string> lines;
+    SnapshotTextBuffer buffer;
+    for (const auto &snapshot : snapshots)
+    {
+        lines.emplace_back(format_snapshot(snapshot, buffer));
+    }
+    std::vector<ScreenCorners> corners;
+    for (const auto &snapshot : snapshots)
+    {
+        if (auto opt_corners = calculate_screen_corners(snapshot); opt_corners.has_value())
+        {
+            corners.push_back(opt_corners.value());
+        }
+    }
+    std::vector<PointF> cursors(snapshots.size());
+    std::vector<uint8_t> valid(snapshots.size());
+
+    std::vector<BenchmarkResult> results;
+    auto bench = [&](std::string name, std::string kind, size_t ops, auto pass) {
+        if (name.find(filter) != std::string::npos)
+        {
+            results.push_back(run_benchmark(config, std::move(name), std::move(kind), ops, pass));
+        }
+    };
+
+    bench("euclidean", "strategy", snapshots.size(), [&]() {
+        size_t ok = 0;
+        for (const auto &snapshot : snapshots)
+        {
+            auto cursor = map_snapshot_to_cursor(snapshot, screen);
+            do_not_optimize(cursor);
+            ok += cursor.has_value();
+        }
+        return ok;
+    });
+    bench("perspective", "strategy", snapshots.size(), [&]() {
+        size_t ok = 0;
+        for (const auto &snapshot : snapshots)
+        {
+            auto cursor = LinAlgPointMapping::map_snapshot_to_cursor(snapshot, screen);
+            do_not_optimize(cursor);
+            ok += cursor.has_value();
+        }
+        return ok;
+    });
+    bench("perspective_batch", "strategy", snapshots.size(), [&]() {
+        LinAlgPointMapping::map_snapshots_to_cursors(snapshots, screen, cursors, valid);
+        do_not_optimize(cursors.front());
+        return static_cast<size_t>(std::ranges::count(valid, 1));
+    });
+    bench("perspective_cached", "strategy", snapshots.size(), [&]() {
+        LinAlgPointMapping::CachedPerspectiveMapper mapper(8);
+        size_t ok = 0;
+        for (const auto &snapshot : snapshots)
+        {
+            auto cursor = mapper.map_snapshot_to_cursor(snapshot, screen);
+            do_not_optimize(cursor);
+            ok += cursor.has_value();
+        }
+        return ok;
+    });
+
+    bench("parse", "stage", lines.size(), [&]() {
+        size_t ok = 0;
+        for (const auto &line : lines)
+        {
+            auto snapshot = parse_snapshot(line);
+            do_not_optimize(snapshot);
+            ok += snapshot.has_value();
+        }
+        return ok;
+    });
+    bench("format", "stage", snapshots.size(), [&]() {
+        SnapshotTextBuffer text;
+        for (const auto &snapshot : snapshots)
+        {
+            auto formatted = format_snapshot(snapshot, text);
+            do_not_optimize(formatted);
+        }
+        return snapshots.size();
+    });
+    bench("corners", "stage", snapshots.size(), [&]() {
+        size_t ok = 0;
+        for (const auto &snapshot : snapshots)
+        {
+            auto screen_corners = calculate_screen_corners(snapshot);
+            do_not_optimize(screen_corners);
+            ok += screen_corners.has_value();
+        }
+        return ok;
+    });
+    bench("borders", "stage", snapshots.size(), [&]() {
+        size_t ok = 0;
+        for (const auto &snapshot : snapshots)
+        {
+            auto snapshot_borders = map_snapshot_to_borders(snapshot);
+            do_not_optimize(snapshot_borders);
+            ok += snapshot_borders.has_value();
+        }
+        return ok;
+    });
+    auto bench_solver = [&](std::string name, LinAlgPointMapping::PerspectiveSolver solver) {
+        bench(std::move(name), "stage", corners.size(), [&corners, &screen, solver]() {
+            size_t ok = 0;
+            for (const auto &src : corners)
+            {
+                auto transform = LinAlgPointMapping::getPerspectiveTransform(src, screen, solver);
+                do_not_optimize(transform);
+                ok += transform.has_value();
+            }
+            return ok;
+        });
+    };
+    bench_solver("transform_closed_form", LinAlgPointMapping::PerspectiveSolver::ClosedForm);
+    bench_solver("transform_gaussian", LinAlgPointMapping::PerspectiveSolver::GaussianElimination);
+
+    // accuracy of the approximations, not timed
+    LinAlgPointMapping::map_snapshots_to_cursors(snapshots, screen, cursors, valid);
+    float batch_max_error = 0;
+    for (size_t i = 0; i < snapshots.size(); i++)
+    {
+        auto scalar = LinAlgPointMapping::map_snapshot_to_cursor(snapshots[i], screen);
+        if (scalar.has_value() && valid[i])
+        {
+            batch_max_error = std::max(batch_max_error, std::hypot(scalar->x - cursors[i].x, scalar->y - cursors[i].y));
+        }
+    }
+    std::string reuse_json;
+    for (float tolerance : {1.0f, 2.0f, 4.0f, 8.0f, 16.0f, 32.0f})
+    {
+        LinAlgPointMapping::CachedPerspectiveMapper mapper(tolerance, true);
+        for (const auto &snapshot : snapshots)
+        {
+            mapper.map_snapshot_to_cursor(snapshot, screen);
+        }
+        const auto &stats = mapper.stats();
+        reuse_json += std::format("{}\n      {{\"tolerance\": {}, \"hit_rate\": {:.4f}, \"max_error_px\": {:.3f}}}",
+            reuse_json.empty() ? "" : ",", tolerance, stats.hit_rate(), stats.max_error);
+    }
+
+    std::string json = std::format("{{\n  \"recording\": \"{}\",\n  \"snapshots\": {},\n  \"warmup\": {},\n  \"repetitions\": {},\n  \"benchmarks\": {}",
+        escape_json(recording_path), snapshots.size(), config.warmup, config.repetitions, benchmarks_json(results));
+    json += std::format(",\n  \"accuracy\": {{\n    \"batch_max_error_px\": {:.5f},\n    \"batch_tolerance_px\": {},\n    \"reuse\": [{}\n    ]\n  }}\n}}\n",
+        batch_max_error, LinAlgPointMapping::batch_tolerance, reuse_json);
+
+    return write_report(json, output_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
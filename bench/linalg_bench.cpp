@@ -0,0 +1,299 @@
+// the LinAlg module against the solver and matrix product it replaced in LinAlgPointMapping.cpp, as JSON.
+// the systems are the 8x8 homography systems of the recording's screen corners, and the 3x3 products compose
+// consecutive homographies. `max_relative_difference` is the largest difference between both solvers' solutions,
+// relative to the legacy solution's element (or absolute below 1).
+// usage: linalg_bench raw_data.txt --output linalg.json
+
+#include <CLI/CLI.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <format>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <vector>
+
+#include "LinAlg.h"
+#include "LinAlgPointMapping.h"
+#include "Recording.h"
+#include "mapping_common.h"
+#include "bench_utils.h"
+
+namespace
+{
+
+// the previous implementation, kept verbatim as the baseline
+namespace legacy
+{
+    template <size_t N> using float_mat = std::array<std::array<float, N>, N>;
+    template <size_t N> using float_arr = std::array<float, N>;
+
+    // destructible call, doesn't copy `lhs` or `rhs`
+    template<size_t N>
+    std::optional<float_arr<N>> gaussianEliminationInPlace(float_mat<N> &lhs, float_arr<N> &rhs) {
+        float_arr<N> result{};
+
+        for (size_t it = 0; it < N; it++) {
+            // select row with largest first element for numerical stability
+            auto pivot_row = it;
+            for (size_t row_it = it + 1; row_it < N; row_it++) {
+                if (std::fabs(lhs[row_it][it]) > std::fabs(lhs[pivot_row][it])) {
+                    pivot_row = row_it;
+                }
+            }
+            if (std::fabs(lhs[pivot_row][it]) < std::numeric_limits<float>::epsilon()) {
+                return std::nullopt;
+            }
+
+            // swap pivot row to the top
+            if (it != pivot_row) {
+                std::swap(lhs[it], lhs[pivot_row]);
+                std::swap(rhs[it], rhs[pivot_row]);
+            }
+
+            // normalize the pivot row (which is now at the top)
+            float norm_factor = lhs[it][it];
+            std::ranges::for_each(lhs[it], [norm_factor](float &f) { f /= norm_factor; });
+            rhs[it] /= norm_factor;
+
+            // eliminate the current column in all rows below
+            for (size_t row_it = it + 1; row_it < N; row_it++) {
+                float elim_factor = lhs[row_it][it];
+                for (size_t col_it = it; col_it < N; col_it++) {
+                    lhs[row_it][col_it] -= elim_factor * lhs[it][col_it];
+                }
+                rhs[row_it] -= elim_factor * rhs[it];
+            }
+        }
+
+        // if we got here, we now have an upper triangular matrix
+        // we can use back substitution to find the solution
+        for (size_t it = 0; it < N; it++) {
+            auto row_it = N - 1 - it;
+            result[row_it] = rhs[row_it];
+            for (size_t col_it = row_it + 1; col_it < N; col_it++) {
+                result[row_it] -= lhs[row_it][col_it] * result[col_it];
+            }
+        }
+
+        return result;
+    }
+
+    template<size_t N>
+    // basic CPU based matrix-matrix multiplication
+    float_mat<N> operator*(const float_mat<N> &lhs, const float_mat<N> &rhs) {
+        float_mat<N> result{};
+        for (size_t row = 0; row < N; row++) {
+            for (size_t col = 0; col < N; col++) {
+                for (size_t it = 0; it < N; it++) {
+                    result[row][col] += lhs[row][it] * rhs[it][col];
+                }
+            }
+        }
+        return result;
+    }
+}
+
+struct System
+{
+    LinAlg::Matrix<float, 8> lhs;
+    LinAlg::Vector<float, 8> rhs{};
+};
+
+// same system as `getPerspectiveTransformGaussian`
+System homography_system(const ScreenCorners &src, const ScreenCorners &dst)
+{
+    System system;
+    auto fill = [&system](size_t i, const PointF &src, const PointF &dst) {
+        system.lhs.set_row(2 * i, src.x, src.y, 1, 0, 0, 0, -1.0f * src.x * dst.x, -1.0f * src.y * dst.x);
+        system.rhs[2 * i] = dst.x;
+        system.lhs.set_row(2 * i + 1, 0, 0, 0, src.x, src.y, 1, -1.0f * src.x * dst.y, -1.0f * src.y * dst.y);
+        system.rhs[2 * i + 1] = dst.y;
+    };
+    fill(0, src.top_left, dst.top_left);
+    fill(1, src.top_right, dst.top_right);
+    fill(2, src.bot_left, dst.bot_left);
+    fill(3, src.bot_right, dst.bot_right);
+    return system;
+}
+
+template <size_t N>
+legacy::float_mat<N> to_legacy(const LinAlg::Matrix<float, N> &matrix)
+{
+    legacy::float_mat<N> result;
+    for (size_t row = 0; row < N; row++)
+    {
+        std::ranges::copy(matrix[row], result[row].begin());
+    }
+    return result;
+}
+
+// a second right hand side for the same matrix, as when the factorization is reused
+LinAlg::Vector<float, 8> second_rhs(const LinAlg::Vector<float, 8> &rhs)
+{
+    LinAlg::Vector<float, 8> result;
+    std::ranges::transform(rhs, result.begin(), [](float value) { return 0.5f * value + 1.0f; });
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CLI::App app{"Lightgun linear algebra benchmarks"};
+
+    std::string recording_path = "raw_data.txt";
+    app.add_option("recording", recording_path, "Text or binary recording to benchmark on")
+        ->check(CLI::ExistingFile)
+        ->capture_default_str();
+
+    BenchmarkConfig config{5, 50};
+    app.add_option("--repetitions", config.repetitions, "Timed passes over the systems, each is one ns/op sample")
+        ->check(CLI::Range(1u, 1000000u))
+        ->capture_default_str();
+
+    std::string output_path;
+    app.add_option("-o,--output", output_path, "Write the JSON report to this file instead of stdout");
+
+    CLI11_PARSE(app, argc, argv);
+
+    auto loaded = Recording::load_snapshots(recording_path);
+    if (!loaded.has_value() || loaded->empty())
+    {
+        printf("Error: no snapshots in %s\n", recording_path.c_str());
+        return EXIT_FAILURE;
+    }
+    const ScreenCorners screen(1920, 1080);
+
+    std::vector<System> systems;
+    std::vector<legacy::float_mat<8>> legacy_lhs;
+    std::vector<LinAlg::Matrix<float, 3>> transforms;
+    std::vector<legacy::float_mat<3>> legacy_transforms;
+    for (const auto &snapshot : loaded.value())
+    {
+        auto corners = calculate_screen_corners(snapshot);
+        if (!corners.has_value())
+        {
+            continue;
+        }
+        systems.push_back(homography_system(corners.value(), screen));
+        legacy_lhs.push_back(to_legacy(systems.back().lhs));
+        if (auto transform = LinAlgPointMapping::getPerspectiveTransform(corners.value(), screen); transform.has_value())
+        {
+            transforms.push_back(transform.value());
+            legacy_transforms.push_back(to_legacy(transform.value()));
+        }
+    }
+    if (systems.empty() || transforms.size() < 2)
+    {
+        printf("Error: no mappable snapshots in %s\n", recording_path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // accuracy, not timed
+    size_t mismatched = 0;
+    double max_difference = 0;
+    for (size_t i = 0; i < systems.size(); i++)
+    {
+        auto lhs = legacy_lhs[i];
+        auto rhs = systems[i].rhs;
+        auto expected = legacy::gaussianEliminationInPlace(lhs, rhs);
+        auto actual = LinAlg::solve(systems[i].lhs, systems[i].rhs);
+        if (expected.has_value() != actual.has_value())
+        {
+            mismatched++;
+            continue;
+        }
+        for (size_t j = 0; expected.has_value() && j < 8; j++)
+        {
+            const double reference = expected.value()[j];
+            max_difference = std::max(max_difference, std::fabs(reference - actual.value()[j]) / std::max(1.0, std::fabs(reference)));
+        }
+    }
+
+    std::vector<BenchmarkResult> results;
+    results.push_back(run_benchmark(config, "solve_8x8_legacy", "solve", systems.size(), [&]() {
+        size_t ok = 0;
+        for (size_t i = 0; i < systems.size(); i++)
+        {
+            auto lhs = legacy_lhs[i];
+            auto rhs = systems[i].rhs;
+            auto solution = legacy::gaussianEliminationInPlace(lhs, rhs);
+            do_not_optimize(solution);
+            ok += solution.has_value();
+        }
+        return ok;
+    }));
+    results.push_back(run_benchmark(config, "solve_8x8_lu", "solve", systems.size(), [&]() {
+        size_t ok = 0;
+        for (const auto &system : systems)
+        {
+            auto solution = LinAlg::solve(system.lhs, system.rhs);
+            do_not_optimize(solution);
+            ok += solution.has_value();
+        }
+        return ok;
+    }));
+
+    // 2 right hand sides per matrix: the legacy solver eliminates twice, LU factorizes once
+    results.push_back(run_benchmark(config, "solve_8x8_two_rhs_legacy", "solve", systems.size(), [&]() {
+        size_t ok = 0;
+        for (size_t i = 0; i < systems.size(); i++)
+        {
+            for (const auto &b : {systems[i].rhs, second_rhs(systems[i].rhs)})
+            {
+                auto lhs = legacy_lhs[i];
+                auto rhs = b;
+                auto solution = legacy::gaussianEliminationInPlace(lhs, rhs);
+                do_not_optimize(solution);
+                ok += solution.has_value();
+            }
+        }
+        return ok / 2;
+    }));
+    results.push_back(run_benchmark(config, "solve_8x8_two_rhs_lu", "solve", systems.size(), [&]() {
+        size_t ok = 0;
+        for (const auto &system : systems)
+        {
+            auto lu = LinAlg::LU<float, 8>::factorize(system.lhs);
+            if (!lu.has_value())
+            {
+                continue;
+            }
+            for (const auto &b : {system.rhs, second_rhs(system.rhs)})
+            {
+                auto solution = lu->solve(b);
+                do_not_optimize(solution);
+            }
+            ok++;
+        }
+        return ok;
+    }));
+
+    // composition of consecutive homographies
+    results.push_back(run_benchmark(config, "multiply_3x3_legacy", "multiply", transforms.size() - 1, [&]() {
+        using legacy::operator*;
+        for (size_t i = 1; i < legacy_transforms.size(); i++)
+        {
+            auto product = legacy_transforms[i] * legacy_transforms[i - 1];
+            do_not_optimize(product);
+        }
+        return legacy_transforms.size() - 1;
+    }));
+    results.push_back(run_benchmark(config, "multiply_3x3", "multiply", transforms.size() - 1, [&]() {
+        for (size_t i = 1; i < transforms.size(); i++)
+        {
+            auto product = transforms[i] * transforms[i - 1];
+            do_not_optimize(product);
+        }
+        return transforms.size() - 1;
+    }));
+
+    std::string json = std::format("{{\n  \"recording\": \"{}\",\n  \"systems\": {},\n"
+                                   "  \"accuracy\": {{\"mismatched\": {}, \"max_relative_difference\": {:.3g}}},\n  \"benchmarks\": {}\n}}\n",
+        escape_json(recording_path), systems.size(), mismatched, max_difference, benchmarks_json(results));
+    return write_report(json, output_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,164 @@
+// how throughput and latency scale with the number of guns, 1 to `GunSet::max_guns`, reported as JSON.
+// every gun replays the recording from memory (a loopback source), paced at --fps or as fast as possible with 0,
+// through its own acquisition and mapping threads. a consumer polls the guns like the render loop does and
+// records the latency from acquisition to pickup. `mapped_fps` counts the frames every mapping thread produced,
+// `picked_fps` the ones the consumer saw, the difference was overwritten before it polled.
+// usage: multigun_bench raw_data.txt --fps 60 --seconds 3 --output multigun.json
+
+#include <CLI/CLI.hpp>
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FramePacer.h"
+#include "GunSet.h"
+#include "IDataAcq.h"
+#include "LatencyHistogram.h"
+#include "Recording.h"
+#include "bench_utils.h"
+
+namespace
+{
+
+class LoopbackSource : public IDataAcq
+{
+public:
+    LoopbackSource(std::span<const Snapshot> snapshots, uint32_t fps) : source(snapshots)
+    {
+        if (fps > 0)
+        {
+            pacer.emplace(std::chrono::nanoseconds(std::chrono::seconds(1)) / fps);
+        }
+    }
+
+    Snapshot get() override
+    {
+        if (pacer.has_value())
+        {
+            pacer->wait_next();
+        }
+        return source.get();
+    }
+
+private:
+    MemorySource source;
+    std::optional<FramePacer> pacer;
+};
+
+std::string percentiles_json(const LatencyHistogram::Counts &counts)
+{
+    return std::format("{{\"p50_ms\": {:.3f}, \"p99_ms\": {:.3f}, \"max_ms\": {:.3f}}}",
+        counts.percentile_ms(0.5), counts.percentile_ms(0.99), counts.max_ms());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CLI::App app{"Lightgun multiple gun scaling benchmarks"};
+
+    std::string recording_path = "raw_data.txt";
+    app.add_option("recording", recording_path, "Text or binary recording every gun replays")
+        ->check(CLI::ExistingFile)
+        ->capture_default_str();
+
+    uint32_t fps = 60;
+    app.add_option("--fps", fps, "Snapshots per second of every gun, 0 for as fast as possible")
+        ->check(CLI::Range(0u, 100000u))
+        ->capture_default_str();
+
+    double seconds = 3;
+    app.add_option("--seconds", seconds, "Run time per number of guns")
+        ->check(CLI::Range(0.1, 600.0))
+        ->capture_default_str();
+
+    size_t max_guns = GunSet::max_guns;
+    app.add_option("--max-guns", max_guns, "Measure 1 up to this many guns")
+        ->check(CLI::Range(size_t{1}, GunSet::max_guns))
+        ->capture_default_str();
+
+    std::string output_path;
+    app.add_option("-o,--output", output_path, "Write the JSON report to this file instead of stdout");
+
+    CLI11_PARSE(app, argc, argv);
+
+    auto snapshots = Recording::load_snapshots(recording_path);
+    if (!snapshots.has_value() || snapshots->empty())
+    {
+        printf("Error: no snapshots in %s\n", recording_path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::string runs_json;
+    for (size_t gun_count = 1; gun_count <= max_guns; gun_count++)
+    {
+        std::vector<std::unique_ptr<LoopbackSource>> loopbacks;
+        std::vector<IDataAcq *> sources;
+        for (size_t gun = 0; gun < gun_count; gun++)
+        {
+            loopbacks.push_back(std::make_unique<LoopbackSource>(snapshots.value(), fps));
+            sources.push_back(loopbacks.back().get());
+        }
+
+        GunSet::Params params;
+        GunSet guns(sources, params);
+        std::vector<LatencyHistogram> pickup(gun_count);
+        std::vector<uint64_t> picked(gun_count, 0);
+
+        // polled like the render loop, which waits up to 1 ms for window events while nothing is new
+        const auto start = std::chrono::steady_clock::now();
+        const auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+        while (std::chrono::steady_clock::now() < end)
+        {
+            if (!guns.update())
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            for (size_t gun = 0; gun < gun_count; gun++)
+            {
+                if (guns.fresh(gun))
+                {
+                    pickup[gun].record(now - guns.frame(gun).capture_time);
+                    picked[gun]++;
+                }
+            }
+        }
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        guns.stop();
+
+        std::string guns_json;
+        LatencyHistogram::Counts total_pickup;
+        LatencyHistogram::Counts total_acquisition;
+        LatencyHistogram::Counts total_mapping;
+        uint64_t total_mapped = 0;
+        uint64_t total_picked = 0;
+        for (size_t gun = 0; gun < gun_count; gun++)
+        {
+            const auto pickup_counts = pickup[gun].counts();
+            const auto mapping_counts = guns.stats(gun).mapping.counts();
+            total_pickup += pickup_counts;
+            total_acquisition += guns.stats(gun).acquisition.counts();
+            total_mapping += mapping_counts;
+            total_mapped += mapping_counts.count;
+            total_picked += picked[gun];
+            guns_json += std::format("{}\n        {{\"mapped_fps\": {:.1f}, \"picked_fps\": {:.1f}, \"pickup\": {}, \"mapping\": {}}}",
+                guns_json.empty() ? "" : ",", mapping_counts.count / elapsed, picked[gun] / elapsed,
+                percentiles_json(pickup_counts), percentiles_json(mapping_counts));
+        }
+        runs_json += std::format("{}\n    {{\"guns\": {}, \"mapped_fps\": {:.1f}, \"picked_fps\": {:.1f}, \"pickup\": {}, "
+                                 "\"acquisition\": {}, \"mapping\": {}, \"per_gun\": [{}\n      ]}}",
+            runs_json.empty() ? "" : ",", gun_count, total_mapped / elapsed, total_picked / elapsed,
+            percentiles_json(total_pickup), percentiles_json(total_acquisition), percentiles_json(total_mapping), guns_json);
+    }
+
+    std::string json = std::format("{{\n  \"recording\": \"{}\",\n  \"fps\": {},\n  \"hardware_threads\": {},\n  \"runs\": [{}\n  ]\n}}\n",
+        escape_json(recording_path), fps, std::thread::hardware_concurrency(), runs_json);
+    return write_report(json, output_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
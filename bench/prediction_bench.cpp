@@ -0,0 +1,263 @@
+// replays a recording at display rate and reports the cursor prediction error, as JSON.
+// every display frame shows the newest mapped cursor that has made it through the pipeline (`latency` after capture),
+// either held or extrapolated to the present time, and is compared against the recorded path at that time.
+// binary recordings are replayed with their capture timestamps, text recordings at `--fps`.
+// usage: prediction_bench record.lgr --display-hz 144 --latency-ms 0 16 33 --output prediction.json
+
+#include <CLI/CLI.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <format>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "CursorPredictor.h"
+#include "DataAcqMappedPlayback.h"
+#include "LinAlgPointMapping.h"
+#include "Recording.h"
+#include "bench_utils.h"
+
+namespace
+{
+
+struct Sample
+{
+    std::chrono::nanoseconds time;
+    PointF cursor;
+    bool starts_run; // the previous frame wasn't mapped
+};
+
+struct PredictorConfig
+{
+    std::string name;
+    CursorPredictor::Params params;
+};
+
+struct ErrorStats
+{
+    size_t count = 0;
+    double rms = 0;
+    double p50 = 0;
+    double p99 = 0;
+    double max = 0;
+};
+
+ErrorStats error_stats(std::vector<float> errors)
+{
+    ErrorStats result;
+    result.count = errors.size();
+    if (errors.empty())
+    {
+        return result;
+    }
+    double sum = 0;
+    for (float error : errors)
+    {
+        sum += static_cast<double>(error) * error;
+    }
+    result.rms = std::sqrt(sum / errors.size());
+    std::ranges::sort(errors);
+    result.p50 = errors[errors.size() / 2];
+    result.p99 = errors[static_cast<size_t>(0.99 * (errors.size() - 1))];
+    result.max = errors.back();
+    return result;
+}
+
+// the timestamped mapped cursors of a recording, nullopt if it can't be read
+std::optional<std::vector<Sample>> load_samples(const std::string &path, uint32_t fps, bool &timestamped)
+{
+    std::vector<Snapshot> snapshots;
+    std::vector<std::chrono::nanoseconds> times;
+    const auto period = std::chrono::nanoseconds(std::chrono::seconds(1)) / fps;
+    timestamped = false;
+    if (Recording::is_binary_recording(path))
+    {
+        DataAcqMappedPlayback playback(path);
+        if (!playback.is_open())
+        {
+            return std::nullopt;
+        }
+        timestamped = playback.timestamp(0).has_value();
+        for (size_t i = 0; i < playback.frame_count(); i++)
+        {
+            snapshots.push_back(playback.frame(i));
+            times.push_back(timestamped ? std::chrono::microseconds(playback.timestamp(i).value()) : static_cast<int64_t>(i) * period);
+        }
+    }
+    else
+    {
+        auto loaded = Recording::load_snapshots(path);
+        if (!loaded.has_value())
+        {
+            return std::nullopt;
+        }
+        snapshots = std::move(loaded.value());
+        for (size_t i = 0; i < snapshots.size(); i++)
+        {
+            times.push_back(static_cast<int64_t>(i) * period);
+        }
+    }
+
+    const ScreenCorners screen(1920, 1080);
+    std::vector<Sample> samples;
+    bool previous_mapped = false;
+    for (size_t i = 0; i < snapshots.size(); i++)
+    {
+        auto cursor = LinAlgPointMapping::map_snapshot_to_cursor(snapshots[i], screen);
+        if (cursor.has_value())
+        {
+            samples.push_back({times[i], cursor.value(), !previous_mapped});
+        }
+        previous_mapped = cursor.has_value();
+    }
+    return samples;
+}
+
+// display frames presented while each sample was the newest one through the pipeline, errors against the recorded path
+std::vector<float> prediction_errors(const std::vector<Sample> &samples, const CursorPredictor::Params &params,
+                                     std::chrono::nanoseconds display_period, std::chrono::nanoseconds latency)
+{
+    std::vector<float> errors;
+    CursorPredictor predictor(params, PointF{1920, 1080});
+    size_t run_end = 0;
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        if (samples[i].starts_run)
+        {
+            predictor.reset();
+            run_end = i + 1;
+            while (run_end < samples.size() && !samples[run_end].starts_run)
+            {
+                run_end++;
+            }
+        }
+        predictor.add(samples[i].cursor, samples[i].time);
+        if (i + 1 >= run_end)
+        {
+            // the recorded path ends with the run, nothing to compare against
+            continue;
+        }
+
+        // the first vertical blank after the sample arrived, on a fixed grid
+        auto available = samples[i].time + latency;
+        auto present = (available / display_period + 1) * display_period;
+        size_t segment = i;
+        for (; present < samples[i + 1].time + latency; present += display_period)
+        {
+            while (segment + 1 < run_end && samples[segment + 1].time < present)
+            {
+                segment++;
+            }
+            if (segment + 1 >= run_end)
+            {
+                break;
+            }
+            const auto &a = samples[segment];
+            const auto &b = samples[segment + 1];
+            float t = std::chrono::duration<float>(present - a.time).count() / std::chrono::duration<float>(b.time - a.time).count();
+            PointF truth{a.cursor.x + t * (b.cursor.x - a.cursor.x), a.cursor.y + t * (b.cursor.y - a.cursor.y)};
+
+            auto predicted = predictor.predict(present).value();
+            errors.push_back(std::hypot(predicted.x - truth.x, predicted.y - truth.y));
+        }
+    }
+    return errors;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CLI::App app{"Lightgun cursor prediction benchmarks"};
+
+    std::string recording_path = "raw_data.txt";
+    app.add_option("recording", recording_path, "Binary (timestamped) or text recording to replay")
+        ->check(CLI::ExistingFile)
+        ->capture_default_str();
+
+    uint32_t fps = 15;
+    app.add_option("--fps", fps, "Frame rate of recordings without timestamps")
+        ->check(CLI::Range(1, 10000))
+        ->capture_default_str();
+
+    uint32_t display_hz = 144;
+    app.add_option("--display-hz", display_hz, "Display refresh rate the cursor is presented at")
+        ->check(CLI::Range(1, 1000))
+        ->capture_default_str();
+
+    std::vector<uint32_t> latencies_ms{0, 16, 33};
+    app.add_option("--latency-ms", latencies_ms, "Capture to display pipeline latencies to compensate")
+        ->capture_default_str();
+
+    BenchmarkConfig config{5, 50};
+    app.add_option("--repetitions", config.repetitions, "Timed passes for the prediction cost")
+        ->check(CLI::Range(1u, 1000000u))
+        ->capture_default_str();
+
+    std::string output_path;
+    app.add_option("-o,--output", output_path, "Write the JSON report to this file instead of stdout");
+
+    CLI11_PARSE(app, argc, argv);
+
+    bool timestamped = false;
+    auto samples = load_samples(recording_path, fps, timestamped);
+    if (!samples.has_value() || samples->size() < 2)
+    {
+        printf("Error: too few mapped frames in %s\n", recording_path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // holding the newest measurement is what the render loop does without prediction
+    std::vector<PredictorConfig> configs;
+    configs.push_back({"hold", {2, std::chrono::milliseconds(0), 0}});
+    for (size_t history = 2; history <= CursorPredictor::max_history; history++)
+    {
+        CursorPredictor::Params params;
+        params.history = history;
+        configs.push_back({std::format("history={}", history), params});
+    }
+    for (int horizon_ms : {33, 50, 100})
+    {
+        for (float step_ratio : {0.5f, 1.0f, 2.0f})
+        {
+            configs.push_back({std::format("history=3 max_horizon={}ms max_step_ratio={}", horizon_ms, step_ratio),
+                               {3, std::chrono::milliseconds(horizon_ms), step_ratio}});
+        }
+    }
+    configs.push_back({"history=3 unclamped", {3, std::chrono::milliseconds(1000), std::numeric_limits<float>::infinity()}});
+
+    const auto display_period = std::chrono::nanoseconds(std::chrono::seconds(1)) / display_hz;
+    std::string predictions_json;
+    for (auto latency_ms : latencies_ms)
+    {
+        for (const auto &predictor_config : configs)
+        {
+            auto errors = error_stats(prediction_errors(samples.value(), predictor_config.params, display_period,
+                                                        std::chrono::milliseconds(latency_ms)));
+            predictions_json += std::format("{}\n    {{\"predictor\": \"{}\", \"latency_ms\": {}, \"frames\": {}, "
+                                            "\"error_px\": {{\"rms\": {:.3f}, \"p50\": {:.3f}, \"p99\": {:.3f}, \"max\": {:.3f}}}}}",
+                predictions_json.empty() ? "" : ",", predictor_config.name, latency_ms, errors.count,
+                errors.rms, errors.p50, errors.p99, errors.max);
+        }
+    }
+
+    // the render loop's work per display frame: a prediction, and a measurement every few frames
+    std::vector<BenchmarkResult> costs;
+    costs.push_back(run_benchmark(config, "add_and_predict", "sample", samples->size(), [&samples]() {
+        CursorPredictor predictor(PointF{1920, 1080});
+        for (const auto &sample : samples.value())
+        {
+            predictor.add(sample.cursor, sample.time);
+            do_not_optimize(predictor.predict(sample.time + std::chrono::milliseconds(8)));
+        }
+        return samples->size();
+    }));
+
+    std::string json = std::format("{{\n  \"recording\": \"{}\",\n  \"timestamps\": {},\n  \"display_hz\": {},\n  \"mapped_frames\": {},\n"
+                                   "  \"predictions\": [{}\n  ],\n  \"benchmarks\": {}\n}}\n",
+        escape_json(recording_path), timestamped, display_hz, samples->size(), predictions_json, benchmarks_json(costs));
+    return write_report(json, output_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,89 @@
+// render throughput of Screen on the headless software renderer, no display needed.
+// every workload renders frames of random pixels and segments, from the game's handful up to debug trails.
+// usage: render_bench --frames 100 --output render.json
+
+#include <CLI/CLI.hpp>
+#include <cstdio>
+#include <format>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "screen.h"
+#include "bench_utils.h"
+
+int main(int argc, char** argv)
+{
+    CLI::App app{"Lightgun render benchmarks"};
+
+    int width = 1824;
+    int height = 1026;
+    app.add_option("--width", width, "Width of the offscreen surface")->capture_default_str();
+    app.add_option("--height", height, "Height of the offscreen surface")->capture_default_str();
+
+    size_t frames = 100;
+    app.add_option("--frames", frames, "Frames rendered per timed pass")
+        ->check(CLI::Range(1u, 1000000u))
+        ->capture_default_str();
+
+    BenchmarkConfig config{2, 20};
+    app.add_option("--warmup", config.warmup, "Untimed passes before measuring")->capture_default_str();
+    app.add_option("--repetitions", config.repetitions, "Timed passes, each is one ns/frame sample")
+        ->check(CLI::Range(1u, 1000000u))
+        ->capture_default_str();
+
+    std::string output_path;
+    app.add_option("-o,--output", output_path, "Write the JSON report to this file instead of stdout");
+
+    CLI11_PARSE(app, argc, argv);
+
+    Screen *screen = Screen::create_headless(width, height);
+    if (screen == nullptr)
+    {
+        printf("Failed to create a headless screen: %s\n", SDL_GetError());
+        return EXIT_FAILURE;
+    }
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> random_x(0, static_cast<float>(width));
+    std::uniform_real_distribution<float> random_y(0, static_cast<float>(height));
+    auto random_point = [&]() { return SDL_FPoint{random_x(rng), random_y(rng)}; };
+
+    struct Workload
+    {
+        size_t pixels;
+        size_t segments;
+    };
+    // the game frame, the debug frame (IR points, corners, borders and cursor lines) and growing trails
+    const std::vector<Workload> workloads = {{1, 0}, {9, 6}, {64, 64}, {512, 512}, {4096, 4096}};
+
+    std::vector<BenchmarkResult> results;
+    for (const auto &workload : workloads)
+    {
+        screen->clear_pixels();
+        screen->clear_segments();
+        for (size_t i = 0; i < workload.pixels; i++)
+        {
+            screen->add_pixel(random_point());
+        }
+        for (size_t i = 0; i < workload.segments; i++)
+        {
+            screen->add_segment({random_point(), random_point()});
+        }
+
+        auto name = std::format("render_{}_pixels_{}_segments", workload.pixels, workload.segments);
+        results.push_back(run_benchmark(config, name, "frame", frames, [screen, frames]() {
+            for (size_t i = 0; i < frames; i++)
+            {
+                screen->render_screen();
+            }
+            do_not_optimize(screen->surface()->pixels);
+            return frames;
+        }));
+    }
+    delete screen;
+
+    std::string json = std::format("{{\n  \"renderer\": \"software\",\n  \"width\": {},\n  \"height\": {},\n  \"warmup\": {},\n  \"repetitions\": {},\n  \"benchmarks\": {}\n}}\n",
+        width, height, config.warmup, config.repetitions, benchmarks_json(results));
+    return write_report(json, output_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,168 @@
+// throughput and accuracy of the perspective mapping per scalar type (float, double and Q16 fixed point), as JSON.
+// the accuracy of each type is its distance to the double cursor on the same snapshot, over the snapshots both map,
+// and `within_tolerance` checks the max against `LinAlgPointMapping::scalar_tolerance`.
+// usage: scalar_bench raw_data.txt --output scalar.json
+
+#include <CLI/CLI.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <format>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "FixedPoint.h"
+#include "LinAlgPointMapping.h"
+#include "Recording.h"
+#include "bench_utils.h"
+
+namespace
+{
+
+struct Accuracy
+{
+    size_t mapped = 0;     // snapshots mapped by the type
+    size_t mismatched = 0; // snapshots mapped by only one of the type and double
+    double mean = 0;
+    double p99 = 0;
+    double max = 0;
+    float tolerance = 0;
+
+    bool within_tolerance() const { return mismatched == 0 && max <= tolerance; }
+
+    std::string to_json() const
+    {
+        return std::format("{{\"mapped\": {}, \"mismatched\": {}, \"error_px\": {{\"mean\": {:.5f}, \"p99\": {:.5f}, \"max\": {:.5f}}}, "
+                           "\"tolerance_px\": {}, \"within_tolerance\": {}}}",
+            mapped, mismatched, mean, p99, max, tolerance, within_tolerance());
+    }
+};
+
+template <typename T>
+std::vector<std::optional<PointF>> map_all(const std::vector<Snapshot> &snapshots)
+{
+    const BasicScreenCorners<T> screen(T(1920), T(1080));
+    std::vector<std::optional<PointF>> cursors;
+    cursors.reserve(snapshots.size());
+    for (const auto &snapshot : snapshots)
+    {
+        auto cursor = LinAlgPointMapping::map_snapshot_to_cursor(snapshot, screen);
+        cursors.push_back(cursor.has_value()
+            ? std::optional<PointF>(PointF{static_cast<float>(cursor->x), static_cast<float>(cursor->y)})
+            : std::nullopt);
+    }
+    return cursors;
+}
+
+template <typename T>
+Accuracy accuracy(const std::vector<Snapshot> &snapshots, const std::vector<std::optional<PointF>> &reference)
+{
+    Accuracy result;
+    result.tolerance = LinAlgPointMapping::scalar_tolerance<T>;
+    auto cursors = map_all<T>(snapshots);
+    std::vector<double> errors;
+    for (size_t i = 0; i < cursors.size(); i++)
+    {
+        result.mapped += cursors[i].has_value();
+        if (cursors[i].has_value() != reference[i].has_value())
+        {
+            result.mismatched++;
+            continue;
+        }
+        if (cursors[i].has_value())
+        {
+            errors.push_back(std::hypot(double(cursors[i]->x) - reference[i]->x, double(cursors[i]->y) - reference[i]->y));
+        }
+    }
+    if (errors.empty())
+    {
+        return result;
+    }
+    double sum = 0;
+    for (double error : errors)
+    {
+        sum += error;
+    }
+    result.mean = sum / errors.size();
+    std::ranges::sort(errors);
+    result.p99 = errors[static_cast<size_t>(0.99 * (errors.size() - 1))];
+    result.max = errors.back();
+    return result;
+}
+
+template <typename T>
+BenchmarkResult throughput(const BenchmarkConfig &config, const std::string &name, const std::vector<Snapshot> &snapshots)
+{
+    const BasicScreenCorners<T> screen(T(1920), T(1080));
+    return run_benchmark(config, name, "scalar", snapshots.size(), [&]() {
+        size_t ok = 0;
+        for (const auto &snapshot : snapshots)
+        {
+            auto cursor = LinAlgPointMapping::map_snapshot_to_cursor(snapshot, screen);
+            do_not_optimize(cursor);
+            ok += cursor.has_value();
+        }
+        return ok;
+    });
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CLI::App app{"Lightgun scalar type benchmarks"};
+
+    std::string recording_path = "raw_data.txt";
+    app.add_option("recording", recording_path, "Text or binary recording to benchmark on")
+        ->check(CLI::ExistingFile)
+        ->capture_default_str();
+
+    BenchmarkConfig config{5, 50};
+    app.add_option("--repetitions", config.repetitions, "Timed passes over the recording, each is one ns/op sample")
+        ->check(CLI::Range(1u, 1000000u))
+        ->capture_default_str();
+
+    std::string output_path;
+    app.add_option("-o,--output", output_path, "Write the JSON report to this file instead of stdout");
+
+    CLI11_PARSE(app, argc, argv);
+
+    auto loaded = Recording::load_snapshots(recording_path);
+    if (!loaded.has_value() || loaded->empty())
+    {
+        printf("Error: no snapshots in %s\n", recording_path.c_str());
+        return EXIT_FAILURE;
+    }
+    const auto &snapshots = loaded.value();
+
+    const auto reference = map_all<double>(snapshots);
+    const auto float_accuracy = accuracy<float>(snapshots, reference);
+    const auto q16_accuracy = accuracy<Q16>(snapshots, reference);
+
+    std::vector<BenchmarkResult> results;
+    results.push_back(throughput<float>(config, "float", snapshots));
+    results.push_back(throughput<double>(config, "double", snapshots));
+    results.push_back(throughput<Q16>(config, "q16", snapshots));
+
+    std::string json = std::format("{{\n  \"recording\": \"{}\",\n  \"snapshots\": {},\n"
+                                   "  \"accuracy\": {{\n    \"float\": {},\n    \"q16\": {}\n  }},\n  \"benchmarks\": {}\n}}\n",
+        escape_json(recording_path), snapshots.size(), float_accuracy.to_json(), q16_accuracy.to_json(), benchmarks_json(results));
+    if (!write_report(json, output_path))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // a type that maps other frames than double, or drifts past its tolerance, fails the run (and the ctest)
+    bool accurate = true;
+    for (const auto &[name, type_accuracy] : {std::pair{"float", float_accuracy}, std::pair{"q16", q16_accuracy}})
+    {
+        if (!type_accuracy.within_tolerance())
+        {
+            printf("Error: %s is out of tolerance, %zu frames mapped by only one of it and double, max error %.5f px, tolerance %.5f px\n",
+                   name, type_accuracy.mismatched, type_accuracy.max, type_accuracy.tolerance);
+            accurate = false;
+        }
+    }
+    return accurate ? EXIT_SUCCESS : EXIT_FAILURE;
+}
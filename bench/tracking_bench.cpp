@@ -0,0 +1,191 @@
+// replays a recording through the partial visibility tracker and reports how many frames it recovers, as JSON.
+// the recovered ratio is over the frames the plain perspective mapping rejects. the positional error is measured
+// on frames where all points are visible: every 1 and 2 point dropout of such a frame is fed to a copy of the
+// tracker (in the state the recording left it in) and compared against the cursor of the full frame.
+// usage: tracking_bench raw_data.txt --output tracking.json
+
+#include <CLI/CLI.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <format>
+#include <string>
+#include <vector>
+
+#include "LinAlgPointMapping.h"
+#include "PartialVisibilityTracker.h"
+#include "Recording.h"
+#include "bench_utils.h"
+
+namespace
+{
+
+using LinAlgPointMapping::PartialVisibilityTracker;
+
+struct ErrorStats
+{
+    size_t frames = 0;    // dropouts fed to the tracker
+    size_t recovered = 0; // dropouts the tracker produced a cursor for
+    double mean_confidence = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p99 = 0;
+    double max = 0;
+
+    std::string to_json() const
+    {
+        return std::format("{{\"frames\": {}, \"recovered\": {}, \"mean_confidence\": {:.3f}, "
+                           "\"error_px\": {{\"mean\": {:.3f}, \"p50\": {:.3f}, \"p99\": {:.3f}, \"max\": {:.3f}}}}}",
+            frames, recovered, mean_confidence, mean, p50, p99, max);
+    }
+};
+
+ErrorStats error_stats(size_t frames, std::vector<float> errors, double confidence_sum)
+{
+    ErrorStats result;
+    result.frames = frames;
+    result.recovered = errors.size();
+    if (errors.empty())
+    {
+        return result;
+    }
+    result.mean_confidence = confidence_sum / errors.size();
+    double sum = 0;
+    for (float error : errors)
+    {
+        sum += error;
+    }
+    result.mean = sum / errors.size();
+    std::ranges::sort(errors);
+    result.p50 = errors[errors.size() / 2];
+    result.p99 = errors[static_cast<size_t>(0.99 * (errors.size() - 1))];
+    result.max = errors.back();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CLI::App app{"Lightgun partial visibility tracking benchmarks"};
+
+    std::string recording_path = "raw_data.txt";
+    app.add_option("recording", recording_path, "Text or binary recording to replay")
+        ->check(CLI::ExistingFile)
+        ->capture_default_str();
+
+    BenchmarkConfig config{5, 50};
+    app.add_option("--repetitions", config.repetitions, "Timed passes for the mapping cost")
+        ->check(CLI::Range(1u, 1000000u))
+        ->capture_default_str();
+
+    std::string output_path;
+    app.add_option("-o,--output", output_path, "Write the JSON report to this file instead of stdout");
+
+    CLI11_PARSE(app, argc, argv);
+
+    auto snapshots = Recording::load_snapshots(recording_path);
+    if (!snapshots.has_value() || snapshots->empty())
+    {
+        printf("Error: no snapshots in %s\n", recording_path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    const ScreenCorners screen(1920, 1080);
+    const Point hidden{dfrobot_max_unit_x, dfrobot_max_unit_x};
+
+    size_t baseline_mapped = 0;
+    size_t partial_frames = 0; // 2 or 3 visible points
+    size_t tracked_recovered = 0;
+    std::vector<float> dropout_errors[2]; // by the number of hidden points - 1
+    double confidence_sums[2] = {0, 0};
+    size_t dropout_frames[2] = {0, 0};
+
+    PartialVisibilityTracker tracker;
+    for (const auto &snapshot : snapshots.value())
+    {
+        auto visible = std::ranges::count_if(snapshot.points, [&hidden](const Point &point) { return point.x != hidden.x || point.y != hidden.y; });
+        if (visible == 2 || visible == 3)
+        {
+            partial_frames++;
+        }
+
+        auto full = LinAlgPointMapping::map_snapshot_to_cursor(snapshot, screen);
+        if (full.has_value())
+        {
+            baseline_mapped++;
+
+            // every way of hiding 1 or 2 of the 4 points, against the tracker as the recording left it
+            for (unsigned mask = 1; mask < (1u << dfrobot_snapshot_size); mask++)
+            {
+                auto hidden_count = std::popcount(mask);
+                if (hidden_count > 2)
+                {
+                    continue;
+                }
+                Snapshot dropout = snapshot;
+                for (size_t i = 0; i < dfrobot_snapshot_size; i++)
+                {
+                    if (mask & (1u << i))
+                    {
+                        dropout.points[i] = hidden;
+                    }
+                }
+                auto probe = tracker;
+                dropout_frames[hidden_count - 1]++;
+                auto result = probe.map_snapshot_to_cursor(dropout, screen);
+                if (result.has_value())
+                {
+                    dropout_errors[hidden_count - 1].push_back(std::hypot(result->cursor.x - full->x, result->cursor.y - full->y));
+                    confidence_sums[hidden_count - 1] += result->confidence;
+                }
+            }
+        }
+
+        auto tracked = tracker.map_snapshot_to_cursor(snapshot, screen);
+        if (tracked.has_value() && !full.has_value())
+        {
+            tracked_recovered++;
+        }
+    }
+
+    const auto &stats = tracker.stats();
+    const size_t rejected = snapshots->size() - baseline_mapped;
+
+    std::vector<BenchmarkResult> costs;
+    costs.push_back(run_benchmark(config, "perspective", "frame", snapshots->size(), [&]() {
+        size_t ok = 0;
+        for (const auto &snapshot : snapshots.value())
+        {
+            auto cursor = LinAlgPointMapping::map_snapshot_to_cursor(snapshot, screen);
+            do_not_optimize(cursor);
+            ok += cursor.has_value();
+        }
+        return ok;
+    }));
+    costs.push_back(run_benchmark(config, "partial_visibility_tracker", "frame", snapshots->size(), [&]() {
+        PartialVisibilityTracker pass_tracker;
+        size_t ok = 0;
+        for (const auto &snapshot : snapshots.value())
+        {
+            auto result = pass_tracker.map_snapshot_to_cursor(snapshot, screen);
+            do_not_optimize(result);
+            ok += result.has_value();
+        }
+        return ok;
+    }));
+
+    std::string json = std::format("{{\n  \"recording\": \"{}\",\n  \"frames\": {},\n  \"partial_frames\": {},\n  \"baseline_mapped\": {},\n"
+                                   "  \"tracked\": {{\"full\": {}, \"recovered_4\": {}, \"recovered_3\": {}, \"recovered_2\": {}, \"lost\": {}}},\n"
+                                   "  \"recovered_ratio\": {:.4f},\n  \"effective_rate_gain\": {:.3f},\n"
+                                   "  \"dropout_1_point\": {},\n  \"dropout_2_points\": {},\n  \"benchmarks\": {}\n}}\n",
+        escape_json(recording_path), snapshots->size(), partial_frames, baseline_mapped,
+        stats.full, stats.recovered_4, stats.recovered_3, stats.recovered_2, stats.lost,
+        rejected > 0 ? static_cast<double>(tracked_recovered) / rejected : 0,
+        baseline_mapped > 0 ? static_cast<double>(baseline_mapped + tracked_recovered) / baseline_mapped : 0,
+        error_stats(dropout_frames[0], dropout_errors[0], confidence_sums[0]).to_json(),
+        error_stats(dropout_frames[1], dropout_errors[1], confidence_sums[1]).to_json(),
+        benchmarks_json(costs));
+    return write_report(json, output_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
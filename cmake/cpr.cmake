@@ -1 +0,0 @@
-CPMAddPackage("gh:libcpr/cpr#1.10.5")
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include "IDataAcq.h"
+#include "LiveStats.h"
+#include "SpscRing.h"
+
+/**
+ * @brief runs an `IDataAcq` on its own thread, so a slow `get()` (e.g. an HTTP round-trip) doesn't stall the caller
+ *
+ * frames are handed over through a lock-free latest-wins ring, the consumer always gets the newest frame.
+ * a consumer waiting for a frame sleeps on a futex the producer wakes after every push, so it picks the frame
+ * up at once instead of on its next poll.
+ */
+class AcquisitionThread
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Frame
+    {
+        Snapshot snapshot;
+        clock::time_point capture_time; // when `get()` returned
+    };
+
+    struct Stats
+    {
+        uint64_t acquired = 0;  // frames returned by the source
+        uint64_t consumed = 0;  // frames handed to the consumer
+        uint64_t dropped = 0;   // frames overwritten by a newer one before the consumer took them
+        uint64_t stale = 0;     // consumer wakeups that found no new frame
+        uint64_t duplicate = 0; // consumed frames identical to the previous consumed frame
+    };
+
+    /** @note `data_acq` must not be used by anyone else until the thread is stopped
+     *  @param live_stats records the duration of every `get()`, nullptr to skip */
+    explicit AcquisitionThread(IDataAcq *data_acq, LiveStats *live_stats = nullptr);
+    ~AcquisitionThread();
+
+    AcquisitionThread(const AcquisitionThread &) = delete;
+    AcquisitionThread &operator=(const AcquisitionThread &) = delete;
+
+    /** @brief consumer side, blocks until a frame newer than the last one arrived
+     * @return the newest frame, nullopt once `stop_token` is stopped */
+    std::optional<Frame> wait_latest(std::stop_token stop_token);
+
+    /** @note consumer side, like `wait_latest()` */
+    Stats stats() const;
+
+    void stop();
+
+private:
+    void run(std::stop_token stop_token);
+    std::optional<Frame> latest();
+    void wake_consumer();
+
+    IDataAcq *data_acq;
+    LiveStats *live_stats;
+    SpscRing<Frame, 4> ring;
+    std::atomic<uint32_t> wakeups{0}; // bumped after every push and on stop, the consumer waits for it to change
+
+    // consumer state
+    std::optional<Snapshot> previous;
+    uint64_t next_sequence = 0;
+    uint64_t consumed = 0;
+    uint64_t dropped = 0;
+    uint64_t stale = 0;
+    uint64_t duplicate = 0;
+
+    std::jthread thread;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+#include "EventLoop.h"
+#include "FrameMapper.h"
+#include "GunSet.h"
+#include "IAsyncDataAcq.h"
+#include "LiveStats.h"
+
+/**
+ * @brief the guns of a `GunSet` as tasks on one `EventLoop` instead of 2 threads per gun
+ *
+ * every gun's task waits for its source's next snapshot and maps it right away, the consumer runs on the same
+ * loop and reads the frames in place, nothing is buffered or shared between threads. `frame_ready()` is notified
+ * for every mapped frame, so the consumer can sleep until there is something to draw.
+ */
+class AsyncGunSet
+{
+public:
+    /** @note the sources must be open and not be used by anyone else, at most `GunSet::max_guns` of them
+     * @note the loop must not run after the set is destroyed */
+    AsyncGunSet(EventLoop &loop, std::span<IAsyncDataAcq *const> sources, const GunSet::Params &params);
+
+    AsyncGunSet(const AsyncGunSet &) = delete;
+    AsyncGunSet &operator=(const AsyncGunSet &) = delete;
+
+    size_t size() const { return guns.size(); }
+
+    /** @brief take the frames mapped since the last call
+     * @return false if no gun mapped anything */
+    bool update();
+
+    /** @brief whether the last `update()` took a new frame of `gun` */
+    bool fresh(size_t gun) const { return guns[gun]->fresh; }
+
+    /** @brief the latest frame of `gun`, only changes while the consumer waits on the loop */
+    const MappedFrame &frame(size_t gun) const { return guns[gun]->frame; }
+
+    /** @brief the metrics of `gun`, its task records acquisition and mapping, the consumer may record the rest */
+    LiveStats &stats(size_t gun) { return guns[gun]->stats; }
+    const LiveStats &stats(size_t gun) const { return guns[gun]->stats; }
+
+    /** @brief notified whenever a gun mapped a frame */
+    EventLoop::Signal &frame_ready() { return ready; }
+
+private:
+    struct Gun
+    {
+        explicit Gun(const GunSet::Params &params);
+
+        LiveStats stats; // before `mapper`, which records into it
+        FrameMapper mapper;
+        MappedFrame frame;
+        bool mapped = false; // since the last `update()`
+        bool fresh = false;
+    };
+
+    Task<void> run(EventLoop &loop, Gun &gun, IAsyncDataAcq *source);
+
+    std::vector<std::unique_ptr<Gun>> guns;
+    EventLoop::Signal ready;
+    bool debug_mode;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "Snapshot.h"
+#include "mapping_common.h"
+#include "LinAlgPointMapping.h"
+
+namespace LinAlgPointMapping {
+    /**
+     * @brief stateful perspective mapping that reuses the last solved transform across near-identical frames
+     *
+     * the transform is re-solved only when any of the 4 IR points moved more than `tolerance` camera units
+     * away from the snapshot the cached transform was solved for.
+     * the reference snapshot is not updated on reuse, so slow drifts can't accumulate past the tolerance.
+     */
+    class CachedPerspectiveMapper
+    {
+    public:
+        struct Stats
+        {
+            uint64_t frames = 0;   // every call
+            uint64_t invalid = 0;  // snapshots that could not be mapped
+            uint64_t reused = 0;   // frames mapped with the cached transform
+            uint64_t solved = 0;   // frames that required a full solve
+            float max_error = 0;   // worst cursor error of a reused frame, only tracked when `measure_error` is set
+
+            float hit_rate() const { return (reused + solved) ? static_cast<float>(reused) / (reused + solved) : 0; }
+        };
+
+        /** @param tolerance max movement (in camera units) of each IR point for the cached transform to be reused
+         *  @param measure_error also solve reused frames from scratch to track the error introduced by the reuse */
+        explicit CachedPerspectiveMapper(float tolerance, bool measure_error = false);
+
+        std::optional<PointF> map_snapshot_to_cursor(const Snapshot &src, const ScreenCorners &dst_corners);
+
+        const Stats &stats() const { return _stats; }
+        void reset();
+
+    private:
+        bool can_reuse(const Snapshot &src, const ScreenCorners &dst_corners) const;
+
+        float _tolerance_squared;
+        bool _measure_error;
+        Stats _stats;
+
+        // the cache is valid only if `_transform` has a value
+        std::optional<float3_mat> _transform;
+        Snapshot _reference;
+        ScreenCorners _dst_corners{0, 0};
+    };
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include "Snapshot.h"
+
+/**
+ * @brief smooths the mapped cursor between mapping and rendering
+ *
+ * filters keep a fixed amount of state and never allocate, `time` is any monotonic timestamp (e.g. the capture time).
+ * a gap longer than `reset_gap` (the target was lost) restarts the filter at the next measurement,
+ * so the cursor doesn't glide from where the target was lost.
+ */
+class ICursorFilter
+{
+public:
+    static constexpr std::chrono::milliseconds reset_gap{250};
+
+    virtual ~ICursorFilter() = default;
+    virtual PointF filter(const PointF &measurement, std::chrono::nanoseconds time) = 0;
+    virtual void reset() = 0;
+};
+
+/**
+ * @brief One Euro filter (Casiez et al. 2012), a low pass whose cutoff rises with the cursor speed
+ *
+ * slow movements are smoothed hard (low jitter), fast ones barely (low lag).
+ */
+class OneEuroFilter final : public ICursorFilter
+{
+public:
+    struct Params
+    {
+        float min_cutoff_hz = 1.0f;        // cutoff at rest, lower is smoother
+        float beta = 0.02f;                // cutoff increase per px/s of speed, higher is less laggy
+        float derivative_cutoff_hz = 1.0f; // smoothing of the speed estimate
+    };
+
+    OneEuroFilter();
+    explicit OneEuroFilter(Params params);
+
+    PointF filter(const PointF &measurement, std::chrono::nanoseconds time) override;
+    void reset() override;
+
+private:
+    struct Axis
+    {
+        float value;
+        float derivative;
+    };
+
+    Params params;
+    std::optional<std::chrono::nanoseconds> last_time;
+    std::array<Axis, 2> axes{};
+};
+
+/**
+ * @brief constant velocity Kalman filter, independent per axis
+ *
+ * the velocity estimate lets it follow steady movement without lag, the noise ratio sets the smoothing.
+ */
+class KalmanFilter final : public ICursorFilter
+{
+public:
+    struct Params
+    {
+        float process_noise = 1e5f;      // acceleration noise density in px^2/s^3, higher follows direction changes faster
+        float measurement_noise = 16.0f; // cursor jitter variance in px^2, higher is smoother
+    };
+
+    KalmanFilter();
+    explicit KalmanFilter(Params params);
+
+    PointF filter(const PointF &measurement, std::chrono::nanoseconds time) override;
+    void reset() override;
+
+private:
+    struct Axis
+    {
+        float position;
+        float velocity;
+        // covariance of (position, velocity)
+        float p00, p01, p11;
+    };
+
+    void update(Axis &axis, float measurement, float dt) const;
+
+    Params params;
+    std::optional<std::chrono::nanoseconds> last_time;
+    std::array<Axis, 2> axes{};
+};
+
+enum class FilterType
+{
+    None,
+    OneEuro,
+    Kalman,
+};
+
+/** @brief run time selection of a cursor filter and its tuning, e.g. from the command line */
+struct CursorFilterConfig
+{
+    FilterType type = FilterType::None;
+    OneEuroFilter::Params one_euro;
+    KalmanFilter::Params kalman;
+};
+
+/** @return nullptr for `FilterType::None` */
+std::unique_ptr<ICursorFilter> make_cursor_filter(const CursorFilterConfig &config);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include "Snapshot.h"
+
+/**
+ * @brief extrapolates the mapped cursor to the present time of a rendered frame
+ *
+ * the camera delivers 15-60 Hz while the display refreshes faster, so the render loop asks for the cursor at the
+ * expected present time of every display frame instead of repeating the last measurement until the next one.
+ * the motion model is the velocity of a least squares line through the last few measurements, and the
+ * extrapolation is clamped (horizon, distance, screen) so a sudden stop or turn can't fling the cursor away.
+ *
+ * like the cursor filters, `time` is any monotonic timestamp and nothing allocates.
+ */
+class CursorPredictor
+{
+public:
+    static constexpr size_t max_history = 4;
+    static constexpr std::chrono::milliseconds reset_gap{250};
+
+    struct Params
+    {
+        size_t history = 2;                         // measurements in the velocity fit, 2 to `max_history`
+        std::chrono::milliseconds max_horizon{100}; // never extrapolate further ahead of the newest measurement
+        float max_step_ratio = 1.0f;                // never move further from the newest measurement than this times the last step
+    };
+
+    /** @param screen_size predictions stay within (0, 0) - `screen_size`, unless the measurement itself is outside */
+    explicit CursorPredictor(PointF screen_size);
+    CursorPredictor(Params params, PointF screen_size);
+
+    void add(const PointF &measurement, std::chrono::nanoseconds time);
+
+    /** @brief the cursor at `time`, nullopt before the first measurement */
+    std::optional<PointF> predict(std::chrono::nanoseconds time) const;
+
+    void reset();
+
+private:
+    struct Sample
+    {
+        PointF position;
+        std::chrono::nanoseconds time;
+    };
+
+    Params params;
+    PointF screen_size;
+    std::array<Sample, max_history> samples{};
+    size_t count = 0; // valid samples, the newest is at `newest`
+    size_t newest = 0;
+    PointF velocity{0, 0}; // px/s, refit on every measurement
+    float last_step = 0;   // px between the two newest measurements
+};
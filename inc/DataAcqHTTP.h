@@ -1,20 +1,71 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
+#include "IAsyncDataAcq.h"
 #include "IDataAcq.h"
 
 /**
  * @brief an HTTP client to obtain data from the ESP32
- * 
+ *
+ * every pipeline slot has one request in flight, so up to `pipeline_depth` requests overlap and the sample rate
+ * isn't capped at 1/RTT. HTTP/1.1 can't overlap requests on one connection (curl dropped pipelining), so depth N
+ * means N kept-alive connections. one curl multi handle drives all of them from the calling thread.
+ * responses are consumed in the order their requests were issued.
+ * `get_async()` drives the same transfers on an event loop: curl reports the sockets it waits for and its timeout
+ * (`CURLMOPT_SOCKETFUNCTION`, `CURLMOPT_TIMERFUNCTION`) into an epoll set of this source, with the timeout as a
+ * timerfd, so one `EventLoop::readable` wait on that set covers every connection and the request timeout.
+ * while requests fail both return only after a short delay, a refused connection fails without waiting.
  */
-class DataAcqHTTP : public IDataAcq
+class DataAcqHTTP final : public IDataAcq, public IAsyncDataAcq
 {
 public:
-    DataAcqHTTP(const std::string &esp_server_ip);
+    struct Stats
+    {
+        uint64_t responses = 0;
+        uint64_t failures = 0;    // failed requests and malformed responses
+        uint64_t duplicates = 0;  // responses identical to the previous one, the camera didn't update yet
+        uint64_t connections = 0; // opened connections, stays at the pipeline depth while they are kept alive
+    };
+
+    DataAcqHTTP(const std::string &esp_server_ip, size_t pipeline_depth = 2,
+                std::chrono::milliseconds timeout = std::chrono::milliseconds(500));
     ~DataAcqHTTP();
 
+    DataAcqHTTP(const DataAcqHTTP &) = delete;
+    DataAcqHTTP &operator=(const DataAcqHTTP &) = delete;
+
     Snapshot get() override;
+    Task<Snapshot> get_async(EventLoop &loop) override;
+
+    /** @brief whether the last snapshot returned by `get()` or `get_async()` was identical to the one before it */
+    bool last_was_duplicate() const;
+    Stats stats() const;
 
 private:
+    struct Multi;
+    struct Request;
+
+    Request &next();
+    void issue(Request &request);
+    void wait_for(const Request &request);
+    void perform_ready();
+    void collect_done();
+    Snapshot take(Request &request);
+    void report_failure(const std::string &reason);
+
     std::string esp_server_ip;
+    std::chrono::milliseconds timeout;
+    std::unique_ptr<Multi> multi;
+    std::vector<Request> requests;
+    size_t next_request = 0;
+
+    std::optional<Snapshot> previous;
+    bool duplicate = false;
+    bool failing = false;
+    Stats _stats;
 };
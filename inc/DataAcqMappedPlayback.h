@@ -0,0 +1,58 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string>
+#include "IAsyncDataAcq.h"
+#include "IDataAcq.h"
+#include "Recording.h"
+#include "FramePacer.h"
+
+/**
+ * @brief playback of a binary recording (see Recording.h), memory mapped and served without copies
+ * @note `seek()` and `frame()` are O(1), playback loops back to the first frame at the end
+ * @note recordings with timestamps are played with their original inter-frame timing, otherwise at a fixed fps
+ * @note `get()` sleeps until a frame is due, `get_async()` waits for it on an event loop timer
+ */
+class DataAcqMappedPlayback final : public IDataAcq, public IAsyncDataAcq
+{
+public:
+    DataAcqMappedPlayback(const std::string &file_name, std::optional<uint32_t> fps = std::nullopt);
+    ~DataAcqMappedPlayback();
+
+    DataAcqMappedPlayback(const DataAcqMappedPlayback &) = delete;
+    DataAcqMappedPlayback &operator=(const DataAcqMappedPlayback &) = delete;
+
+    Snapshot get() override;
+    Snapshot get(bool no_sleep);
+    Task<Snapshot> get_async(EventLoop &loop) override;
+    bool is_open() const;
+
+    const Recording::Header &header() const;
+    size_t frame_count() const;
+    const Snapshot &frame(size_t index) const;
+    std::optional<Recording::Timestamp> timestamp(size_t index) const;
+
+    /** @brief the next `get()` returns frame `index` */
+    void seek(size_t index);
+    size_t position() const;
+
+    FramePacer::Stats pacing_stats() const;
+
+private:
+    void rewind_at_end();
+    /** @return when the next frame is due, nullopt without pacing */
+    std::optional<FramePacer::clock::time_point> schedule();
+
+    void *mapping = nullptr;
+    size_t mapping_size = 0;
+    const Recording::Header *_header = nullptr;
+    std::span<const Snapshot> frames;
+    std::span<const Recording::Timestamp> timestamps;
+    size_t next_frame = 0;
+    uint32_t fps = 0;
+
+    FramePacer pacer;
+    // timestamps are replayed relative to this frame
+    size_t schedule_origin = 0;
+};
@@ -2,9 +2,11 @@
 
 #include <string>
 #include <fstream>
+#include "IAsyncDataAcq.h"
 #include "IDataAcq.h"
+#include "FramePacer.h"
 
-class DataAcqPlayback : public IDataAcq
+class DataAcqPlayback final : public IDataAcq, public IAsyncDataAcq
 {
 public:
     DataAcqPlayback(std::string file_name, uint8_t fps);
@@ -12,10 +14,13 @@ public:
 
     Snapshot get() override;
     Snapshot get(bool no_sleep);
+    Task<Snapshot> get_async(EventLoop &loop) override;
     bool is_open();
+    FramePacer::Stats pacing_stats() const;
 
 private:
     std::ifstream input;
     std::string line;
     uint8_t fps;
+    FramePacer pacer;
 };
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "IAsyncDataAcq.h"
+#include "IDataAcq.h"
+#include "Datagram.h"
+#include "SampleWindow.h"
+
+/**
+ * @brief receives snapshots pushed by the device as UDP datagrams (see Datagram.h)
+ *
+ * `get()` drains every queued datagram and returns the newest one, packets older than the newest
+ * delivered packet are stale and dropped. a 64 packet window tells reordered packets from duplicates,
+ * so late packets aren't counted as lost. `get_async()` does the same on an event loop, it waits for the socket
+ * without a timeout, a silent stream costs no wakeups.
+ */
+class DataAcqUDP final : public IDataAcq, public IAsyncDataAcq
+{
+public:
+    struct Stats
+    {
+        uint64_t received = 0;   // valid packets
+        uint64_t delivered = 0;  // snapshots returned by `get()`
+        uint64_t superseded = 0; // in order packets replaced by a newer one in the same `get()`
+        uint64_t lost = 0;       // sequence numbers never received (so far)
+        uint64_t reordered = 0;  // arrived after a newer packet, dropped as stale
+        uint64_t duplicate = 0;
+        uint64_t malformed = 0;
+        uint64_t timeouts = 0;
+        uint64_t resyncs = 0;    // sender restarts
+        double latency_p50_us = 0; // one-way latency above the fastest packet, the clock offset is unknown
+        double latency_p99_us = 0;
+        double latency_max_us = 0;
+
+        std::string to_string() const;
+    };
+
+    /** @param timeout `get()` returns `Snapshot::invalid()` if nothing new arrived for this long */
+    explicit DataAcqUDP(uint16_t port, std::chrono::milliseconds timeout = std::chrono::milliseconds(100));
+    ~DataAcqUDP();
+
+    DataAcqUDP(const DataAcqUDP &) = delete;
+    DataAcqUDP &operator=(const DataAcqUDP &) = delete;
+
+    Snapshot get() override;
+    Task<Snapshot> get_async(EventLoop &loop) override;
+    bool is_open() const;
+
+    /** @brief not synchronized with `get()`, read it once acquisition stopped */
+    Stats stats() const;
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    /** @brief receive the queued datagrams, the first with `flags`
+     * @return true if `newest` was replaced by a newer snapshot */
+    bool receive(Snapshot &newest, int flags);
+    void delivered();
+    /** @return true if the packet is newer than everything received so far */
+    bool accept(const Datagram::Packet &packet, clock::time_point receive_time);
+    void record_latency(uint64_t device_time_us, clock::time_point receive_time);
+
+    int socket_fd = -1;
+    std::chrono::milliseconds timeout;
+
+    // sequence window, bit i is set if `highest_sequence - i` was received
+    bool synced = false;
+    uint32_t highest_sequence = 0;
+    uint64_t window = 0;
+    uint32_t out_of_window = 0; // consecutive packets too old for the window, a sender restart after a few
+
+    // receive time minus device time, relative to the first packet so the samples stay small enough for floats
+    int64_t first_offset_us = 0;
+    float min_offset_us = 0;
+    SampleWindow<> offset_us;
+
+    Stats _stats;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+#include "Snapshot.h"
+
+/**
+ * UDP snapshot datagram (version 1), one `Packet` per datagram, all values little endian.
+ * the sender numbers packets sequentially (wrapping at 2^32) and stamps them with its own monotonic clock.
+ */
+namespace Datagram {
+    static_assert(std::endian::native == std::endian::little, "the datagram format is little endian");
+
+    // the last character is the format version
+    inline constexpr std::array<char, 4> magic{'L', 'G', 'D', '1'};
+
+    struct Packet
+    {
+        std::array<char, 4> magic;
+        uint32_t sequence;
+        uint64_t device_time_us;
+        Snapshot snapshot;
+    };
+    static_assert(sizeof(Packet) == 32);
+    static_assert(std::is_trivially_copyable_v<Packet>);
+
+    /** @brief signed distance from `from` to `to`, correct across the 2^32 wrap */
+    constexpr int32_t sequence_distance(uint32_t from, uint32_t to)
+    {
+        return static_cast<int32_t>(to - from);
+    }
+    static_assert(sequence_distance(0xFFFFFFFF, 1) == 2);
+    static_assert(sequence_distance(5, 3) == -2);
+};
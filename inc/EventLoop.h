@@ -0,0 +1,274 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <list>
+#include <optional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "LatencyHistogram.h"
+
+template <typename T = void>
+class Task;
+
+namespace detail
+{
+    template <typename T>
+    struct TaskResult
+    {
+        std::optional<T> value;
+
+        void return_value(T result) { value = std::move(result); }
+        T take() { return std::move(value.value()); }
+    };
+
+    template <>
+    struct TaskResult<void>
+    {
+        void return_void() {}
+        void take() {}
+    };
+}
+
+/**
+ * @brief a lazily started coroutine, run by `co_await`ing it from another task or with `EventLoop::spawn`
+ *
+ * the awaiting coroutine is resumed by symmetric transfer when the task finishes, so chains of tasks don't
+ * grow the stack. exceptions aren't used in this code base, an escaping one terminates.
+ */
+template <typename T>
+class [[nodiscard]] Task
+{
+public:
+    struct promise_type : detail::TaskResult<T>
+    {
+        std::coroutine_handle<> continuation = std::noop_coroutine();
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept
+        {
+            struct Final
+            {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    return handle.promise().continuation;
+                }
+                void await_resume() noexcept {}
+            };
+            return Final{};
+        }
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    Task(Task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task &operator=(Task &&other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    ~Task() { destroy(); }
+
+    bool done() const { return !handle || handle.done(); }
+
+    bool await_ready() const { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting)
+    {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    T await_resume() { return handle.promise().take(); }
+
+private:
+    friend class EventLoop;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    void destroy()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * @brief single-threaded epoll event loop that resumes coroutines on readable file descriptors and timers
+ *
+ * all timers share one timerfd armed at the earliest deadline, so waiting costs no thread and no polling, an idle
+ * loop blocks in `epoll_wait` until something is due. `stop()` may be called from any thread, everything else
+ * only from the thread in `run()` (i.e. from the tasks). timers and waits don't allocate once the queues grew.
+ */
+class EventLoop
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Stats
+    {
+        uint64_t wakeups = 0;     // returns from `epoll_wait`
+        uint64_t timer_events = 0;
+        uint64_t io_events = 0;
+        uint64_t signals = 0;     // `Signal::notify` resumptions
+        LatencyHistogram::Counts timer_lateness; // from a timer's deadline until its task runs
+        LatencyHistogram::Counts io_dispatch;    // from the wakeup until the task waiting for the descriptor runs
+        double run_seconds = 0;  // wall time in `run()`
+        double idle_seconds = 0; // of which blocked in `epoll_wait`
+        double cpu_seconds = 0;  // CPU time of the loop's thread in `run()`, updated when `run()` returns
+
+        std::string to_string() const;
+    };
+
+    /**
+     * @brief wakes one waiting task, either at its deadline or on `notify()`, whichever comes first
+     * @note a notify without a waiting task is kept, the next wait returns at once
+     * @note the loop keeps the deadline of the last wait, the signal must not be destroyed before `run()` returned
+     */
+    class Signal
+    {
+    public:
+        explicit Signal(EventLoop &loop) : loop(loop) {}
+
+        Signal(const Signal &) = delete;
+        Signal &operator=(const Signal &) = delete;
+
+        void notify();
+
+        /** @brief awaitable, resumes with true if notified and false at `deadline` */
+        auto wait_until(clock::time_point deadline)
+        {
+            struct Awaiter
+            {
+                Signal &signal;
+                clock::time_point deadline;
+
+                bool await_ready()
+                {
+                    signal.notified = std::exchange(signal.pending, false);
+                    return signal.notified;
+                }
+                void await_suspend(std::coroutine_handle<> handle)
+                {
+                    signal.waiter = handle;
+                    signal.loop.add_timer(deadline, handle, &signal);
+                }
+                bool await_resume() { return signal.notified; }
+            };
+            return Awaiter{*this, deadline};
+        }
+
+    private:
+        friend class EventLoop;
+
+        EventLoop &loop;
+        std::coroutine_handle<> waiter;
+        uint64_t generation = 0; // invalidates the timer of a wait that was notified
+        bool pending = false;
+        bool notified = false;
+    };
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    bool is_open() const;
+
+    /** @brief run `task` on the loop, it starts with the next `run()` iteration and is destroyed when it finished */
+    void spawn(Task<void> task);
+
+    /** @brief resume tasks until `stop()` */
+    void run();
+
+    /** @brief makes `run()` return after the current iteration, from any thread */
+    void stop();
+
+    /** @brief awaitable, resumes at `deadline` (at once if it passed) */
+    auto sleep_until(clock::time_point deadline)
+    {
+        struct Awaiter
+        {
+            EventLoop &loop;
+            clock::time_point deadline;
+
+            bool await_ready() const { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { loop.add_timer(deadline, handle, nullptr); }
+            void await_resume() const {}
+        };
+        return Awaiter{*this, deadline};
+    }
+
+    /** @brief awaitable, resumes once `fd` is readable, the task reads it (non-blocking) itself */
+    auto readable(int fd)
+    {
+        struct Awaiter
+        {
+            EventLoop &loop;
+            int fd;
+
+            bool await_ready() const { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { loop.wait_readable(fd, handle); }
+            void await_resume() const {}
+        };
+        return Awaiter{*this, fd};
+    }
+
+    /** @note the CPU time is only updated when `run()` returns */
+    Stats stats() const;
+
+private:
+    struct Timer
+    {
+        clock::time_point deadline;
+        std::coroutine_handle<> handle;
+        Signal *signal;      // nullptr for a plain sleep
+        uint64_t generation; // of `signal` when the timer was added
+
+        bool operator>(const Timer &other) const { return deadline > other.deadline; }
+    };
+
+    void add_timer(clock::time_point deadline, std::coroutine_handle<> handle, Signal *signal);
+    void wait_readable(int fd, std::coroutine_handle<> handle);
+    void post(std::coroutine_handle<> handle);
+    void arm_timerfd();
+    void fire_timers(clock::time_point now);
+    void resume_ready();
+
+    int epoll_fd = -1;
+    int timer_fd = -1;
+    int stop_fd = -1; // eventfd, written by `stop()`
+    bool stopping = false;
+
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+    std::vector<Timer> due;
+    std::optional<clock::time_point> armed_deadline;
+    std::unordered_map<int, std::coroutine_handle<>> readers; // added to the epoll set once, re-armed as one-shot on every wait
+    std::vector<std::coroutine_handle<>> ready;
+    std::vector<std::coroutine_handle<>> running;
+    std::list<Task<void>> tasks;
+
+    uint64_t wakeups = 0;
+    uint64_t timer_events = 0;
+    uint64_t io_events = 0;
+    uint64_t signals = 0;
+    LatencyHistogram timer_lateness;
+    LatencyHistogram io_dispatch;
+    clock::duration run_time{};
+    clock::duration idle_time{};
+    std::chrono::nanoseconds cpu_time{};
+};
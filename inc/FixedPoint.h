@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief signed Q(31 - FracBits).FracBits fixed point number in 32 bits, for targets without a fast FPU (the ESP32)
+ *
+ * products and quotients are computed in 64 bits and rounded to the nearest step, every operation saturates
+ * instead of wrapping around, and a division by zero saturates towards the sign of the numerator.
+ * conversions from and to floating point are meant for constants (folded at compile time) and for the host.
+ */
+template <int FracBits>
+class Fixed
+{
+    static_assert(FracBits > 0 && FracBits < 31);
+
+public:
+    static constexpr int frac_bits = FracBits;
+    static constexpr int64_t one = int64_t(1) << FracBits;
+
+    constexpr Fixed() = default;
+
+    template <std::integral I>
+    constexpr explicit Fixed(I value) : _raw(saturate(static_cast<int64_t>(value) * one)) {}
+
+    template <std::floating_point F>
+    constexpr explicit Fixed(F value)
+        : _raw(saturate(static_cast<int64_t>(std::clamp<F>(value * one + (value < 0 ? F(-0.5) : F(0.5)), raw_min, raw_max))))
+    {
+    }
+
+    static constexpr Fixed from_raw(int32_t raw)
+    {
+        Fixed result;
+        result._raw = raw;
+        return result;
+    }
+
+    constexpr int32_t raw() const { return _raw; }
+
+    template <std::floating_point F>
+    constexpr explicit operator F() const { return static_cast<F>(_raw) / one; }
+
+    constexpr Fixed operator-() const { return from_raw(saturate(-static_cast<int64_t>(_raw))); }
+
+    friend constexpr Fixed operator+(Fixed lhs, Fixed rhs) { return from_raw(saturate(static_cast<int64_t>(lhs._raw) + rhs._raw)); }
+    friend constexpr Fixed operator-(Fixed lhs, Fixed rhs) { return from_raw(saturate(static_cast<int64_t>(lhs._raw) - rhs._raw)); }
+
+    friend constexpr Fixed operator*(Fixed lhs, Fixed rhs)
+    {
+        const int64_t product = static_cast<int64_t>(lhs._raw) * rhs._raw;
+        return from_raw(saturate((product + (one >> 1)) >> FracBits));
+    }
+
+    friend constexpr Fixed operator/(Fixed lhs, Fixed rhs)
+    {
+        const int64_t numerator = static_cast<int64_t>(lhs._raw) * one;
+        if (rhs._raw == 0)
+        {
+            return from_raw(numerator < 0 ? raw_min : raw_max);
+        }
+        // round half away from zero
+        const int64_t half = (rhs._raw < 0 ? -rhs._raw : rhs._raw) / 2;
+        return from_raw(saturate(((numerator < 0) ? numerator - half : numerator + half) / rhs._raw));
+    }
+
+    constexpr Fixed &operator+=(Fixed rhs) { return *this = *this + rhs; }
+    constexpr Fixed &operator-=(Fixed rhs) { return *this = *this - rhs; }
+    constexpr Fixed &operator*=(Fixed rhs) { return *this = *this * rhs; }
+    constexpr Fixed &operator/=(Fixed rhs) { return *this = *this / rhs; }
+
+    friend constexpr auto operator<=>(Fixed lhs, Fixed rhs) = default;
+
+    friend constexpr Fixed abs(Fixed value) { return value._raw < 0 ? -value : value; }
+
+private:
+    static constexpr int32_t raw_min = std::numeric_limits<int32_t>::min();
+    static constexpr int32_t raw_max = std::numeric_limits<int32_t>::max();
+
+    static constexpr int32_t saturate(int64_t raw)
+    {
+        return static_cast<int32_t>(std::clamp<int64_t>(raw, raw_min, raw_max));
+    }
+
+    int32_t _raw = 0;
+};
+
+/** @brief the on-device format, 1/65536 steps up to +-32768 (enough for the 10 bit camera coordinates) */
+using Q16 = Fixed<16>;
+
+template <int FracBits>
+struct std::numeric_limits<Fixed<FracBits>>
+{
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = true;
+    static constexpr int digits = 31;
+
+    // the smallest step, like for floating point it's the distance from 1 to the next value
+    static constexpr Fixed<FracBits> epsilon() { return Fixed<FracBits>::from_raw(1); }
+    static constexpr Fixed<FracBits> min() { return lowest(); }
+    static constexpr Fixed<FracBits> max() { return Fixed<FracBits>::from_raw(std::numeric_limits<int32_t>::max()); }
+    static constexpr Fixed<FracBits> lowest() { return Fixed<FracBits>::from_raw(std::numeric_limits<int32_t>::min()); }
+};
+
+static_assert(sizeof(Q16) == sizeof(int32_t));
+static_assert(Q16(1.5f) * Q16(-2) == Q16(-3));
+static_assert(Q16(1) / Q16(3) == Q16::from_raw(21845));
+static_assert(Q16(30000) + Q16(30000) == std::numeric_limits<Q16>::max());
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include "CachedPerspectiveMapper.h"
+#include "CursorFilter.h"
+#include "LiveStats.h"
+#include "MappingError.h"
+#include "PartialVisibilityTracker.h"
+#include "PointMapping.h"
+#include "mapping_common.h"
+
+/** @brief everything the renderer needs from one mapped frame */
+struct MappedFrame
+{
+    uint64_t sequence = 0; // counts the mapped frames, 0 until the first one
+    Snapshot snapshot;
+    std::chrono::steady_clock::time_point capture_time;
+    std::optional<PointF> cursor; // filtered if the mapping thread has a cursor filter
+    float confidence = 0;         // 1 if all IR points were seen, lower while tracking partial visibility
+    std::optional<borders> debug_borders; // only in debug mode
+    std::optional<MappingError> error;
+};
+
+/**
+ * @brief maps the snapshots of one gun to `MappedFrame`s, with the state that carries over between frames
+ * (transform reuse, partial visibility, the cursor filter)
+ *
+ * shared by `MappingThread` and the event loop's `AsyncGunSet`, which map on different threads.
+ */
+class FrameMapper
+{
+public:
+    /** @param cursor_filter smooths the mapped cursor, nullptr for the raw cursor
+     *  @param track_partial_visibility keep mapping frames with 2 or 3 visible IR points, replaces the transform reuse
+     *  @param live_stats records the mapping times and the invalid and failed frames, nullptr to skip */
+    FrameMapper(const ScreenCorners &screen_corners, bool debug_mode, float reuse_tolerance,
+                std::unique_ptr<ICursorFilter> cursor_filter = nullptr, bool track_partial_visibility = false,
+                LiveStats *live_stats = nullptr);
+
+    void map(const Snapshot &snapshot, std::chrono::steady_clock::time_point capture_time, MappedFrame &mapped);
+
+private:
+    void map_frame(const Snapshot &snapshot, std::chrono::steady_clock::time_point capture_time, MappedFrame &mapped);
+
+    ScreenCorners screen_corners;
+    bool debug_mode;
+    std::optional<LinAlgPointMapping::CachedPerspectiveMapper> cached_mapper;
+    std::optional<LinAlgPointMapping::PartialVisibilityTracker> tracker;
+    std::unique_ptr<ICursorFilter> cursor_filter;
+    uint64_t mapped_frames = 0;
+    LiveStats *live_stats;
+};
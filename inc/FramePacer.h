@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "SampleWindow.h"
+
+/**
+ * @brief paces a loop against absolute `steady_clock` deadlines
+ *
+ * deadlines are `start + n * period` (or `start + offset` for recorded timing), so time spent between
+ * waits (HTTP latency, mapping, rendering) doesn't accumulate into drift.
+ * if a deadline is missed by more than a period, the schedule is realigned instead of bursting to catch up.
+ */
+class FramePacer
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Stats
+    {
+        uint64_t ticks = 0;
+        uint64_t realigned = 0;     // deadlines missed by more than a period
+        double achieved_rate = 0;   // ticks per second since the first tick
+        double jitter_p50_us = 0;   // wakeup lateness after the deadline
+        double jitter_p99_us = 0;
+        double jitter_max_us = 0;
+
+        std::string to_string() const;
+    };
+
+    /** @param period target interval between ticks, zero for pacing only with `wait_until_offset()` */
+    explicit FramePacer(std::chrono::nanoseconds period = std::chrono::nanoseconds::zero());
+
+    /** @brief sleep until the next periodic deadline
+     * @return the deadline that was waited for */
+    clock::time_point wait_next();
+
+    /** @brief sleep until `offset` after the start of the schedule, used to replay recorded timestamps */
+    clock::time_point wait_until_offset(std::chrono::nanoseconds offset);
+
+    /** @brief the next periodic deadline without waiting for it, e.g. to wait on an event loop timer instead
+     * @note call `tick()` once the deadline passed, to keep the statistics */
+    clock::time_point schedule_next();
+
+    /** @brief the deadline `offset` after the start of the schedule, without waiting for it, see `schedule_next()` */
+    clock::time_point schedule_offset(std::chrono::nanoseconds offset);
+
+    /** @brief record a wakeup for `deadline` in the statistics */
+    void tick(clock::time_point deadline);
+
+    /** @brief start a new schedule from now, statistics are kept */
+    void restart();
+
+    Stats stats() const;
+    void reset_stats();
+
+private:
+    void wait_until(clock::time_point deadline);
+
+    std::chrono::nanoseconds period;
+    clock::time_point start;
+    clock::time_point next_deadline;
+    bool started = false;
+
+    clock::time_point first_tick;
+    clock::time_point last_tick;
+    uint64_t ticks = 0;
+    uint64_t realigned = 0;
+
+    // lateness of the most recent ticks
+    SampleWindow<> lateness_us;
+};
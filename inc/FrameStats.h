@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "SampleWindow.h"
+
+/**
+ * @brief frame-time statistics of the render loop
+ */
+class FrameStats
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Summary
+    {
+        uint64_t presented = 0;
+        uint64_t skipped = 0;           // loop iterations without a new frame, nothing was drawn
+        uint64_t overlay_refreshed = 0; // presents of only a new overlay, not in `presented` or the statistics
+        double present_rate = 0;        // presented frames per second
+        SampleWindow<>::Percentiles frame_time_ms; // between consecutive presents of new input
+        SampleWindow<>::Percentiles latency_ms;    // from acquisition to present
+
+        std::string to_string() const;
+    };
+
+    void skipped();
+    void presented(clock::time_point capture_time);
+    void overlay_refreshed();
+
+    Summary summary() const;
+
+private:
+    uint64_t skipped_frames = 0;
+    uint64_t presented_frames = 0;
+    uint64_t overlay_refreshes = 0;
+    clock::time_point first_present;
+    clock::time_point last_present;
+    SampleWindow<> frame_time_ms;
+    SampleWindow<> latency_ms;
+};
@@ -6,34 +6,140 @@
 class LineSegment
 {
 public:
-    explicit LineSegment(const PointF &p1, const PointF &p2);
+    constexpr explicit LineSegment(const PointF &p1, const PointF &p2) : p1(p1), p2(p2) {}
     PointF p1;
     PointF p2;
 private:
     LineSegment() = delete;
 };
 
-class Line
+/** @brief a 2d point in homogeneous coordinates, `w == 0` is a point at infinity (the direction of parallel lines) */
+template <typename T>
+struct BasicHomogeneousPoint
+{
+    T x;
+    T y;
+    T w;
+
+    constexpr bool is_at_infinity() const { return w == T(0); }
+
+    constexpr std::optional<BasicPoint<T>> to_point() const
+    {
+        if (is_at_infinity())
+        {
+            return std::nullopt;
+        }
+        return BasicPoint<T>{x / w, y / w};
+    }
+};
+
+using HomogeneousPointF = BasicHomogeneousPoint<float>;
+
+/**
+ * @brief a line in homogeneous coordinates, all points that satisfy `a * x + b * y + c = 0`
+ *
+ * vertical lines (`b == 0`) need no special representation, and the intersection of 2 lines is
+ * their cross product, which is a point at infinity when the lines are parallel.
+ */
+template <typename T>
+class BasicLine
 {
 public:
-    Line(float m, float n);
-    Line(const PointF& point, float m);
+    /** @brief the line `y = m * x + n` */
+    constexpr BasicLine(T m, T n) : _a(m), _b(-1), _c(n) {}
+
+    /** @brief the line through `point` with slope `m` */
+    constexpr BasicLine(const BasicPoint<T> &point, T m) : BasicLine(m, point.y - m * point.x) {}
+
+    /** @brief the line through `point` with `inverted_m` x units per y unit, vertical when `inverted_m == 0` */
+    static constexpr BasicLine from_inverted_slope(const BasicPoint<T> &point, T inverted_m)
+    {
+        return BasicLine(T(-1), inverted_m, point.x - inverted_m * point.y);
+    }
+
+    static constexpr BasicLine vertical(T x_const) { return BasicLine(T(1), T(0), -x_const); }
+
+    /** @brief the line through `p1` and `p2`, the cross product of both points, nullopt if the points are identical */
+    static constexpr std::optional<BasicLine> from_points(const BasicPoint<T> &p1, const BasicPoint<T> &p2)
+    {
+        if (p1.x == p2.x && p1.y == p2.y)
+        {
+            return std::nullopt;
+        }
+        return BasicLine(p1.y - p2.y, p2.x - p1.x, p1.x * p2.y - p2.x * p1.y);
+    }
 
-    static Line vertical(float x_const);
-    static std::optional<Line> from_points(const PointF &p1, const PointF &p2);
+    constexpr std::optional<T> y(T x) const
+    {
+        if (is_vertical())
+        {
+            // we can't map x to y
+            return std::nullopt;
+        }
+        return -(_a * x + _c) / _b;
+    }
 
-    std::optional<float> y(float x) const;
-    std::optional<float> x(float y) const;
-    std::optional<PointF> intersection(const Line &other) const;
-    std::optional<PointF> perpendicular_foot(const PointF &point) const;
-    Line perpendicular(const PointF &point) const;
+    constexpr std::optional<T> x(T y) const
+    {
+        if (is_horizontal())
+        {
+            // we can't map y to x
+            return std::nullopt;
+        }
+        return -(_b * y + _c) / _a;
+    }
 
-    std::optional<float> _m;
-    std::optional<float> _n;
-    std::optional<float> _x_const;
-    inline constexpr bool is_horizontal() const { return _m.has_value() && _m.value() == 0; }
-    inline constexpr bool is_vertical() const { return _x_const.has_value(); }
+    constexpr std::optional<T> slope() const
+    {
+        if (is_vertical())
+        {
+            return std::nullopt;
+        }
+        return -_a / _b;
+    }
+
+    /** @brief branch-free intersection, a point at infinity if the lines are parallel */
+    constexpr BasicHomogeneousPoint<T> homogeneous_intersection(const BasicLine &other) const
+    {
+        return {_b * other._c - _c * other._b,
+                _c * other._a - _a * other._c,
+                _a * other._b - _b * other._a};
+    }
+
+    constexpr std::optional<BasicPoint<T>> intersection(const BasicLine &other) const
+    {
+        return homogeneous_intersection(other).to_point();
+    }
+
+    /** @brief the line through `point` perpendicular to this line (its normal is this line's direction) */
+    constexpr BasicLine perpendicular(const BasicPoint<T> &point) const
+    {
+        return BasicLine(-_b, _a, _b * point.x - _a * point.y);
+    }
+
+    constexpr std::optional<BasicPoint<T>> perpendicular_foot(const BasicPoint<T> &point) const
+    {
+        return intersection(perpendicular(point));
+    }
+
+    constexpr bool is_horizontal() const { return _a == T(0); }
+    constexpr bool is_vertical() const { return _b == T(0); }
+
+    constexpr T a() const { return _a; }
+    constexpr T b() const { return _b; }
+    constexpr T c() const { return _c; }
 
 private:
-    Line();
+    constexpr BasicLine(T a, T b, T c) : _a(a), _b(b), _c(c) {}
+
+    T _a;
+    T _b;
+    T _c;
 };
+
+using Line = BasicLine<float>;
+
+static_assert(sizeof(Line) == 3 * sizeof(float));
+static_assert(Line(2, 1).y(3) == 7);
+static_assert(Line::vertical(4).intersection(Line(0, 5)).value().x == 4);
+static_assert(Line(1, 0).homogeneous_intersection(Line(1, 2)).is_at_infinity());
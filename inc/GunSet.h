@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+#include "CursorFilter.h"
+#include "IDataAcq.h"
+#include "LiveStats.h"
+#include "MappingThread.h"
+#include "mapping_common.h"
+
+/**
+ * @brief up to `max_guns` light guns played at the same time, each with its own acquisition and mapping thread
+ *
+ * the guns share nothing but their settings. every gun lives in its own cache line aligned allocation with the
+ * render thread's bookkeeping on a separate line, so the threads of one gun never write to a line of another.
+ */
+class GunSet
+{
+public:
+    static constexpr size_t max_guns = 4;
+
+    struct Params
+    {
+        ScreenCorners screen_corners{1920, 1080};
+        bool debug_mode = false;
+        float reuse_tolerance = 0;
+        CursorFilterConfig filter; // every gun gets its own filter
+        bool track_partial_visibility = false;
+    };
+
+    /** @note the sources must not be used by anyone else until the guns are stopped, at most `max_guns` of them */
+    GunSet(std::span<IDataAcq *const> sources, const Params &params);
+
+    GunSet(const GunSet &) = delete;
+    GunSet &operator=(const GunSet &) = delete;
+
+    size_t size() const { return guns.size(); }
+
+    /** @brief consumer side, take the latest mapped frame of every gun
+     * @return false if no gun mapped anything since the last call */
+    bool update();
+
+    /** @brief consumer side, whether the last `update()` took a new frame of `gun` */
+    bool fresh(size_t gun) const { return guns[gun]->fresh; }
+
+    /** @brief consumer side, the latest frame of `gun` taken by `update()` */
+    const MappedFrame &frame(size_t gun) const { return guns[gun]->mapping.frame(); }
+
+    /** @brief the metrics of `gun`, its threads record acquisition and mapping, the consumer may record the rest */
+    LiveStats &stats(size_t gun) { return guns[gun]->stats; }
+    const LiveStats &stats(size_t gun) const { return guns[gun]->stats; }
+
+    void stop();
+
+private:
+    struct alignas(64) Gun
+    {
+        Gun(IDataAcq *source, const Params &params);
+
+        LiveStats stats; // before `mapping`, whose threads record into it
+        MappingThread mapping;
+        alignas(64) bool fresh = false; // consumer only
+    };
+
+    std::vector<std::unique_ptr<Gun>> guns;
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "EventLoop.h"
+#include "Snapshot.h"
+
+/** @brief a source that waits for its next snapshot on an `EventLoop` (a socket, a playback timer) instead of blocking */
+class IAsyncDataAcq
+{
+public:
+    virtual ~IAsyncDataAcq() = default;
+    /** @note like `IDataAcq::get()`, one task at a time per source */
+    virtual Task<Snapshot> get_async(EventLoop &loop) = 0;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief lock-free fixed-bucket histogram of durations, in microseconds, with HDR-style log-linear buckets
+ *
+ * values below `2 * sub_buckets` us have a bucket each, above that every power of 2 is split into `sub_buckets`
+ * buckets, so a percentile is within 1 / `sub_buckets` (~3%) of the true value up to `max_trackable_us`.
+ * recording is a relaxed `fetch_add` on the bucket, any number of threads can record and read at the same time,
+ * nothing allocates. reading isn't a consistent snapshot while recording goes on, which only matters for the
+ * last few values.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr uint32_t sub_bucket_bits = 5;
+    static constexpr uint64_t sub_buckets = uint64_t(1) << sub_bucket_bits;
+    static constexpr uint32_t max_magnitude = 26; // the top power of 2, ~67 s
+    static constexpr uint64_t max_trackable_us = (uint64_t(1) << (max_magnitude + 1)) - 1;
+    static constexpr size_t bucket_count = (max_magnitude - sub_bucket_bits + 2) * sub_buckets;
+
+    /** @brief plain copy of the bucket counts, e.g. to diff two points in time for the values in between */
+    struct Counts
+    {
+        std::array<uint64_t, bucket_count> buckets{};
+        uint64_t count = 0;
+        uint64_t max_us = 0; // exact for a whole histogram, within the bucket precision for a diff
+
+        /** @brief the values recorded since `earlier` (a copy of the same histogram) */
+        Counts since(const Counts &earlier) const;
+
+        /** @brief adds the values of another histogram, e.g. the same metric of several guns */
+        Counts &operator+=(const Counts &other);
+
+        /** @brief the smallest value at or above `p` (0 to 1) of the values, 0 if there are none */
+        double percentile_ms(double p) const;
+        double max_ms() const { return max_us / 1000.0; }
+    };
+
+    void record(std::chrono::nanoseconds duration);
+    void record_us(uint64_t value_us);
+
+    Counts counts() const;
+    uint64_t count() const { return _count.load(std::memory_order_relaxed); }
+
+    static size_t bucket_index(uint64_t value_us);
+    /** @brief the largest value that falls into the same bucket as `bucket_index` */
+    static uint64_t bucket_upper_us(size_t bucket_index);
+
+private:
+    std::array<std::atomic<uint64_t>, bucket_count> buckets{};
+    std::atomic<uint64_t> _count{0};
+    std::atomic<uint64_t> _max_us{0};
+};
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+
+/**
+ * @brief fixed-size dense linear algebra, `constexpr` and generic over the scalar type (float, double, `Q16`)
+ *
+ * matrices are stored row-major in one flat array, small sizes (up to `unroll_limit`) are unrolled at compile time,
+ * so the 3x3 homographies compile to straight-line code. nothing allocates or throws, a singular system is a nullopt.
+ */
+namespace LinAlg {
+    template <typename T, size_t N> using Vector = std::array<T, N>;
+
+    /** @brief sizes up to this are unrolled into straight-line code, larger ones are loops */
+    inline constexpr size_t unroll_limit = 4;
+
+    /** @brief calls `f(i)` for `begin <= i < end`, unrolled with the bounds folded away when `N` is small
+     * @note `end` must not be larger than `N`
+     * @note the callers are `gnu::flatten`, gcc doesn't inline the nested lambdas at -O2 otherwise and each unrolled
+     * step becomes a call, which made a 3x3 product 2.5x slower than plain loops */
+    template <size_t N, typename F>
+    constexpr void for_range(size_t begin, size_t end, F &&f)
+    {
+        if constexpr (N <= unroll_limit)
+        {
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                ((I < begin || I >= end ? void() : f(I)), ...);
+            }(std::make_index_sequence<N>{});
+        }
+        else
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                f(i);
+            }
+        }
+    }
+
+    // `std::abs` for floating point compiles to a sign mask, a compare and negate would branch on the data
+    template <typename T>
+    constexpr T magnitude(T value)
+    {
+        using std::abs;
+        return abs(value);
+    }
+
+    template <typename T, size_t Rows, size_t Cols = Rows>
+    struct Matrix
+    {
+        std::array<T, Rows * Cols> elements{};
+
+        static constexpr size_t rows = Rows;
+        static constexpr size_t cols = Cols;
+
+        static constexpr Matrix identity()
+        {
+            static_assert(Rows == Cols);
+            Matrix result;
+            for_range<Rows>(0, Rows, [&](size_t i) { result(i, i) = T(1); });
+            return result;
+        }
+
+        constexpr T &operator()(size_t row, size_t col) { return elements[row * Cols + col]; }
+        constexpr const T &operator()(size_t row, size_t col) const { return elements[row * Cols + col]; }
+
+        constexpr std::span<T, Cols> operator[](size_t row) { return std::span<T, Cols>(elements.data() + row * Cols, Cols); }
+        constexpr std::span<const T, Cols> operator[](size_t row) const
+        {
+            return std::span<const T, Cols>(elements.data() + row * Cols, Cols);
+        }
+
+        /** @brief assigns the `Cols` values to the row, e.g. `set_row(0, x, y, 1)` */
+        template <typename... Values>
+        constexpr void set_row(size_t row, Values... values)
+        {
+            static_assert(sizeof...(Values) == Cols);
+            // written one by one, copying a just built row array stalled the stores on forwarding to the wider loads
+            size_t col = 0;
+            (((*this)(row, col++) = T(values)), ...);
+        }
+
+        constexpr void swap_rows(size_t a, size_t b)
+        {
+            // element by element, `std::swap_ranges` over the flat array was 30% of an 8x8 factorization
+            for_range<Cols>(0, Cols, [&](size_t col) { std::swap((*this)(a, col), (*this)(b, col)); });
+        }
+
+        friend constexpr bool operator==(const Matrix &, const Matrix &) = default;
+    };
+
+    template <typename T, size_t Rows, size_t Cols>
+    [[gnu::flatten]] constexpr Vector<T, Rows> operator*(const Matrix<T, Rows, Cols> &lhs, const Vector<T, Cols> &rhs)
+    {
+        Vector<T, Rows> result{};
+        for_range<Rows>(0, Rows, [&](size_t row) {
+            T sum(0);
+            for_range<Cols>(0, Cols, [&](size_t col) { sum += lhs(row, col) * rhs[col]; });
+            result[row] = sum;
+        });
+        return result;
+    }
+
+    template <typename T, size_t Rows, size_t Inner, size_t Cols>
+    [[gnu::flatten]] constexpr Matrix<T, Rows, Cols> operator*(const Matrix<T, Rows, Inner> &lhs, const Matrix<T, Inner, Cols> &rhs)
+    {
+        Matrix<T, Rows, Cols> result;
+        for_range<Rows>(0, Rows, [&](size_t row) {
+            for_range<Cols>(0, Cols, [&](size_t col) {
+                T sum(0);
+                for_range<Inner>(0, Inner, [&](size_t it) { sum += lhs(row, it) * rhs(it, col); });
+                result(row, col) = sum;
+            });
+        });
+        return result;
+    }
+
+    template <typename T, size_t Rows, size_t Cols>
+    constexpr Matrix<T, Rows, Cols> operator/(Matrix<T, Rows, Cols> lhs, T rhs)
+    {
+        for (auto &element : lhs.elements)
+        {
+            element /= rhs;
+        }
+        return lhs;
+    }
+
+    /**
+     * @brief LU factorization with partial pivoting, `P * A = L * U`
+     *
+     * factorizing is O(N^3) and every `solve` after it O(N^2), so systems that share the matrix and differ in the
+     * right hand side (e.g. the x and y rows of a homography) factorize once.
+     */
+    template <typename T, size_t N>
+    class LU
+    {
+    public:
+        /** @return nullopt if a pivot is smaller than `min_pivot` in magnitude, i.e. `a` is (numerically) singular */
+        [[gnu::flatten]] static constexpr std::optional<LU> factorize(const Matrix<T, N> &a, T min_pivot = std::numeric_limits<T>::epsilon())
+        {
+            // factorized in place in the returned optional, every return is `result` so it isn't copied
+            std::optional<LU> result(LU{});
+            result->lu = a;
+            for_range<N>(0, N, [&](size_t i) { result->permutation[i] = i; });
+
+            // the pivot steps are a plain loop for the early return, a flag checked in every step was 15% slower at 8x8
+            auto &lu = result->lu;
+            for (size_t k = 0; k < N; k++)
+            {
+                // select the row with the largest element in the column for numerical stability
+                size_t pivot_row = k;
+                for_range<N>(k + 1, N, [&](size_t row) {
+                    if (magnitude(lu(row, k)) > magnitude(lu(pivot_row, k)))
+                    {
+                        pivot_row = row;
+                    }
+                });
+                if (magnitude(lu(pivot_row, k)) < min_pivot)
+                {
+                    result.reset();
+                    return result;
+                }
+                if (pivot_row != k)
+                {
+                    lu.swap_rows(k, pivot_row);
+                    std::swap(result->permutation[k], result->permutation[pivot_row]);
+                    result->odd_permutation = !result->odd_permutation;
+                }
+
+                // the multipliers (L) replace the eliminated column below the pivot
+                const T pivot = lu(k, k);
+                for_range<N>(k + 1, N, [&](size_t row) {
+                    const T factor = lu(row, k) / pivot;
+                    lu(row, k) = factor;
+                    for_range<N>(k + 1, N, [&](size_t col) { lu(row, col) -= factor * lu(k, col); });
+                });
+            }
+            return result;
+        }
+
+        /** @brief `x` with `A * x = b`, reusing the factorization */
+        [[gnu::flatten]] constexpr Vector<T, N> solve(const Vector<T, N> &b) const
+        {
+            // forward substitution through the unit lower triangle, on the permuted `b`
+            Vector<T, N> x{};
+            for_range<N>(0, N, [&](size_t row) {
+                T sum = b[permutation[row]];
+                for_range<N>(0, row, [&](size_t col) { sum -= lu(row, col) * x[col]; });
+                x[row] = sum;
+            });
+
+            // back substitution through the upper triangle
+            for_range<N>(0, N, [&](size_t it) {
+                const size_t row = N - 1 - it;
+                T sum = x[row];
+                for_range<N>(row + 1, N, [&](size_t col) { sum -= lu(row, col) * x[col]; });
+                x[row] = sum / lu(row, row);
+            });
+            return x;
+        }
+
+        constexpr T determinant() const
+        {
+            T result(odd_permutation ? -1 : 1);
+            for_range<N>(0, N, [&](size_t i) { result *= lu(i, i); });
+            return result;
+        }
+
+    private:
+        LU() = default;
+
+        Matrix<T, N> lu;                  // L below the diagonal (its diagonal is 1), U on and above it
+        std::array<size_t, N> permutation{}; // row `i` of `lu` is row `permutation[i]` of the factorized matrix
+        bool odd_permutation = false;
+    };
+
+    /** @brief `x` with `a * x = b`, nullopt if `a` is singular */
+    template <typename T, size_t N>
+    constexpr std::optional<Vector<T, N>> solve(const Matrix<T, N> &a, const Vector<T, N> &b)
+    {
+        auto lu = LU<T, N>::factorize(a);
+        if (!lu.has_value())
+        {
+            return std::nullopt;
+        }
+        return lu->solve(b);
+    }
+
+    namespace detail {
+        template <typename T, size_t N>
+        constexpr bool near(const Vector<T, N> &lhs, const Vector<T, N> &rhs, T tolerance)
+        {
+            return std::ranges::all_of(std::views::iota(size_t(0), N),
+                                       [&](size_t i) { return magnitude(lhs[i] - rhs[i]) <= tolerance; });
+        }
+
+        // a 5x5 (looped) system that needs pivot swaps: the anti-diagonal plus a small diagonal
+        constexpr Matrix<double, 5> looped_system()
+        {
+            Matrix<double, 5> a;
+            for (size_t i = 0; i < 5; i++)
+            {
+                a(i, 4 - i) = 4 + double(i);
+                a(i, i) += 0.5;
+            }
+            return a;
+        }
+    }
+
+    // unrolled 3x3 with a row swap
+    static_assert(solve(Matrix<double, 3>{{2, 1, 1, 4, -6, 0, -2, 7, 2}}, Vector<double, 3>{5, -2, 9}) == Vector<double, 3>{1, 1, 2});
+    static_assert(LU<double, 3>::factorize(Matrix<double, 3>{{2, 1, 1, 4, -6, 0, -2, 7, 2}})->determinant() == -16);
+    static_assert(!LU<float, 3>::factorize(Matrix<float, 3>{{1, 2, 3, 2, 4, 6, 1, 0, 1}}).has_value());
+    static_assert(Matrix<int, 2>{{1, 2, 3, 4}} * Matrix<int, 2>::identity() == Matrix<int, 2>{{1, 2, 3, 4}});
+
+    // looped 5x5, one factorization for several right hand sides
+    static_assert([] {
+        constexpr auto a = detail::looped_system();
+        constexpr auto lu = LU<double, 5>::factorize(a).value();
+        for (const Vector<double, 5> &x : {Vector<double, 5>{1, 2, 3, 4, 5}, Vector<double, 5>{-1, 0, 0.25, 8, -3}})
+        {
+            if (!detail::near(lu.solve(a * x), x, 1e-12))
+            {
+                return false;
+            }
+        }
+        return true;
+    }());
+};
@@ -1,10 +1,57 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <optional>
+#include <span>
 
+#include "FixedPoint.h"
+#include "LinAlg.h"
 #include "Snapshot.h"
 #include "mapping_common.h"
 
 namespace LinAlgPointMapping {
-    std::optional<PointF> map_snapshot_to_cursor(const Snapshot &src, const ScreenCorners &dst_corners);
+    template <typename T, size_t N> using scalar_mat = LinAlg::Matrix<T, N>;
+    template <typename T, size_t N> using scalar_arr = LinAlg::Vector<T, N>;
+    template <size_t N> using float_mat = scalar_mat<float, N>;
+    template <size_t N> using float_arr = scalar_arr<float, N>;
+
+    using float3_mat = float_mat<3>;
+
+    enum class PerspectiveSolver
+    {
+        GaussianElimination, // 8x8 linear system solved by LU factorization with partial pivoting
+        ClosedForm,          // composition of square-to-quad homographies
+    };
+
+    /** @brief homography mapping the `src` quad onto the `dst` quad, normalized so the bottom right element is 1
+     * @return nullopt if either quad is degenerate */
+    std::optional<float3_mat> getPerspectiveTransform(const ScreenCorners &src, const ScreenCorners &dst,
+                                                      PerspectiveSolver solver = PerspectiveSolver::ClosedForm);
+
+    /** @brief map the IR camera center (where the gun points) through a perspective transform */
+    std::optional<PointF> map_camera_center(const float3_mat &transform);
+
+    /** @brief map a snapshot to a cursor on the `dst_corners` quad, computed in the scalar type `T`
+     * @note instantiated for float, double and `Q16` (FixedPoint.h), which scales the coordinates to about [-1, 1]
+     * to stay in range. cursors match the double instance within `scalar_tolerance<T>` */
+    template <typename T>
+    std::optional<BasicPoint<T>> map_snapshot_to_cursor(const Snapshot &src, const BasicScreenCorners<T> &dst_corners);
+
+    /** @brief max distance (in dst units, pixels for a 1920x1080 screen) between a cursor of `map_snapshot_to_cursor<T>`
+     * and the double instance */
+    template <typename T> inline constexpr float scalar_tolerance = 0;
+    template <> inline constexpr float scalar_tolerance<float> = 0.01f;
+    template <> inline constexpr float scalar_tolerance<Q16> = 1.0f;
+
+    /** @brief max distance (in dst units) between a batched cursor and the cursor of `map_snapshot_to_cursor` */
+    inline constexpr float batch_tolerance = 0.01f;
+
+    /** @brief map many snapshots at once, the snapshots are processed in lanes (structure-of-arrays) to allow vectorization
+     * @param cursors mapped cursor per snapshot, left untouched where the snapshot couldn't be mapped
+     * @param valid set to 1 where the snapshot was mapped and 0 otherwise
+     * @pre `cursors` and `valid` are at least as large as `src`, otherwise an error is printed and no cursor is mapped
+     * @note cursors match `map_snapshot_to_cursor` within `batch_tolerance` */
+    void map_snapshots_to_cursors(std::span<const Snapshot> src, const ScreenCorners &dst_corners,
+                                  std::span<PointF> cursors, std::span<uint8_t> valid);
 };
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "LatencyHistogram.h"
+
+/**
+ * @brief per-frame metrics of the running game, recorded by the acquisition, mapping and render threads
+ *
+ * every metric has a single writer, readers (the overlay, the shutdown summary) may look at any time,
+ * recording is lock-free and allocation-free.
+ */
+struct LiveStats
+{
+    using clock = std::chrono::steady_clock;
+
+    LatencyHistogram acquisition; // `IDataAcq::get()` or `get_async()`, e.g. the HTTP round-trip or the playback pacing
+    LatencyHistogram mapping;     // `FrameMapper::map`, including the cursor filter
+    LatencyHistogram render;      // `Screen::render_screen`, including the wait for the vertical blank with vsync
+    LatencyHistogram end_to_end;  // from the snapshot's acquisition to the present of its cursor
+    LatencyHistogram frame_time;  // between consecutive presents
+
+    std::atomic<uint64_t> invalid_frames{0}; // unmapped snapshots with a missing or out of range IR point
+    std::atomic<uint64_t> failed_frames{0};  // unmapped snapshots with all IR points
+
+    /** @brief p50/p99/max of every histogram with values and the frame counts, since the start */
+    std::string summary() const;
+};
+
+/**
+ * @brief the overlay text, recomputed every `interval` from the values recorded during it
+ *
+ * the previous bucket counts are kept as plain copies and the text is formatted into a fixed buffer,
+ * so updating doesn't allocate either. with several sources (e.g. one per gun plus the render thread's) every
+ * metric is the sum of all sources.
+ */
+class LiveStatsWindow
+{
+public:
+    static constexpr auto interval = std::chrono::seconds(1);
+
+    explicit LiveStatsWindow(const LiveStats &stats);
+    explicit LiveStatsWindow(std::vector<const LiveStats *> sources);
+
+    /** @return true if an interval passed since the last update and `text()` changed */
+    bool update(LiveStats::clock::time_point now);
+
+    /** @brief one metric per line, in ms */
+    std::string_view text() const { return {buffer.data(), length}; }
+
+private:
+    std::vector<const LiveStats *> sources;
+    LiveStats::clock::time_point last_update;
+    std::array<LatencyHistogram::Counts, 5> previous;
+    uint64_t previous_invalid = 0;
+    uint64_t previous_failed = 0;
+    std::array<char, 256> buffer{};
+    size_t length = 0;
+};
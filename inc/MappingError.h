@@ -0,0 +1,37 @@
+#pragma once
+
+#include <expected>
+
+/** @brief reasons a snapshot can't be mapped to a cursor */
+enum class MappingError
+{
+    InvalidSnapshot,      // one of the points is missing or out of the camera range
+    CornerClassification, // the points couldn't be assigned to 4 distinct corners
+    DegenerateLine,       // two points that should define a line are identical
+    VerticalLine,         // a line that must have a slope is vertical
+    NoIntersection,       // two lines that must intersect are parallel
+    DivisionByZero,
+};
+
+template <typename T>
+using MappingResult = std::expected<T, MappingError>;
+
+constexpr const char *to_string(MappingError error)
+{
+    switch (error)
+    {
+    case MappingError::InvalidSnapshot:
+        return "invalid snapshot";
+    case MappingError::CornerClassification:
+        return "failed to map the snapshot to 4 corners";
+    case MappingError::DegenerateLine:
+        return "failed to create a line from 2 identical points";
+    case MappingError::VerticalLine:
+        return "unexpected vertical line";
+    case MappingError::NoIntersection:
+        return "lines don't intersect";
+    case MappingError::DivisionByZero:
+        return "division by zero";
+    }
+    return "unknown error";
+}
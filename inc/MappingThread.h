@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+#include "AcquisitionThread.h"
+#include "CursorFilter.h"
+#include "FrameMapper.h"
+#include "TripleBuffer.h"
+#include "mapping_common.h"
+
+/**
+ * @brief maps the frames of an `AcquisitionThread` on its own thread, and hands the latest result to the renderer
+ *
+ * SDL has to render and handle events on the thread that created the window, so the main thread keeps those
+ * and everything else (acquisition, mapping) runs behind a triple buffer.
+ */
+class MappingThread
+{
+public:
+    /** @note `data_acq` must not be used by anyone else until the thread is stopped
+     *  @param cursor_filter smooths the mapped cursor, nullptr for the raw cursor
+     *  @param track_partial_visibility keep mapping frames with 2 or 3 visible IR points, replaces the transform reuse
+     *  @param live_stats records the acquisition and mapping times and the invalid and failed frames, nullptr to skip */
+    MappingThread(IDataAcq *data_acq, const ScreenCorners &screen_corners, bool debug_mode, float reuse_tolerance,
+                  std::unique_ptr<ICursorFilter> cursor_filter = nullptr, bool track_partial_visibility = false,
+                  LiveStats *live_stats = nullptr);
+    ~MappingThread();
+
+    MappingThread(const MappingThread &) = delete;
+    MappingThread &operator=(const MappingThread &) = delete;
+
+    /** @brief consumer side, take the latest mapped frame
+     * @return false if nothing was mapped since the last call */
+    bool update();
+
+    /** @brief consumer side, the frame taken by the last successful `update()` */
+    const MappedFrame &frame() const;
+
+    void stop();
+
+private:
+    void run(std::stop_token stop_token);
+
+    AcquisitionThread acquisition;
+    FrameMapper mapper;
+    bool debug_mode;
+
+    TripleBuffer<MappedFrame> output;
+    std::jthread thread;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "MappingError.h"
+#include "Snapshot.h"
+#include "mapping_common.h"
+#include "LinAlgPointMapping.h"
+
+namespace LinAlgPointMapping {
+    /**
+     * @brief stateful perspective mapping that keeps producing a cursor while only 2 or 3 IR points are visible
+     *
+     * every mapped frame stores its IR points by corner. when points drop out, the visible ones are matched to the
+     * stored corners (moved on by the last frame's motion), the missing corners follow the affine (3 points) or
+     * similarity (2 points) transform of the matched ones, and the completed quad is mapped like a full frame.
+     * the track survives up to `max_partial_frames` consecutive frames without all points, the confidence drops
+     * with every visible point missing and every partial frame in a row.
+     */
+    class PartialVisibilityTracker
+    {
+    public:
+        struct Params
+        {
+            uint32_t max_partial_frames = 15; // consecutive frames without all points before the track is dropped
+            float max_match_distance = 150;   // camera units between a visible point and the corner it's matched to
+            float max_scale_change = 1.25f;   // 2 visible points, max change of their distance since the last frame
+        };
+
+        struct Result
+        {
+            PointF cursor;
+            float confidence; // 1 with all points visible, towards 0 the longer the missing points are estimated
+            uint32_t visible; // IR points seen in the frame
+        };
+
+        struct Stats
+        {
+            uint64_t frames = 0;
+            uint64_t full = 0;        // all 4 points visible and classified
+            uint64_t recovered_4 = 0; // 4 points visible but not classified, matched to the tracked corners
+            uint64_t recovered_3 = 0; // mapped from 3 visible points
+            uint64_t recovered_2 = 0; // mapped from 2 visible points
+            uint64_t lost = 0;        // frames without a cursor
+        };
+
+        PartialVisibilityTracker();
+        explicit PartialVisibilityTracker(Params params);
+
+        /** @return `MappingError::InvalidSnapshot` for a partial frame the track couldn't complete */
+        MappingResult<Result> map_snapshot_to_cursor(const Snapshot &src, const ScreenCorners &dst_corners);
+
+        const Stats &stats() const { return _stats; }
+        void reset();
+
+    private:
+        using Quad = std::array<PointF, 4>; // IR points in the order top left, top right, bottom left, bottom right
+
+        std::optional<Quad> complete(const Snapshot &src) const;
+        void coast();
+
+        Params _params;
+        Stats _stats;
+
+        // the track is valid only if `_corners` has a value
+        std::optional<Quad> _corners; // the last measured quad
+        PointF _motion{0, 0};         // of the quad's center between the last 2 measured quads, in camera units per frame
+        uint32_t _coasted_frames = 0; // frames without a cursor since `_corners` was measured
+        uint32_t _partial_frames = 0;
+    };
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Snapshot.h"
+
+/**
+ * binary recording format (version 1), all values little endian:
+ * - `Header`
+ * - `frame_count` frame records, each is a `Snapshot` (4 points of 2 uint16_t)
+ * - optional timestamp column: `frame_count` uint64_t capture timestamps in microseconds
+ *
+ * fixed size records in columns allow O(1) random access to any frame and its timestamp.
+ */
+namespace Recording {
+    static_assert(std::endian::native == std::endian::little, "the recording format is little endian");
+
+    inline constexpr std::array<char, 4> magic{'L', 'G', 'R', 'C'};
+    inline constexpr uint16_t format_version = 1;
+
+    enum Flags : uint16_t
+    {
+        HasTimestamps = 1 << 0,
+    };
+
+    struct Header
+    {
+        std::array<char, 4> magic;
+        uint16_t version;
+        uint16_t flags;
+        uint32_t fps;
+        uint16_t snapshot_size;
+        uint16_t max_unit_x;
+        uint16_t max_unit_y;
+        uint16_t reserved[3];
+        uint64_t frame_count;
+    };
+    static_assert(sizeof(Header) == 32);
+
+    using FrameRecord = Snapshot;
+    static_assert(sizeof(FrameRecord) == dfrobot_snapshot_size * 2 * sizeof(uint16_t));
+    static_assert(std::is_trivially_copyable_v<FrameRecord>);
+
+    using Timestamp = uint64_t;
+
+    /** @brief check the header against this build's format version and sensor constants
+     * @return an error message, nullopt if the header is valid */
+    std::optional<std::string> validate(const Header &header, size_t file_size);
+
+    /** @brief check if a file starts with the binary recording magic */
+    bool is_binary_recording(const std::string &file_name);
+
+    /**
+     * @brief writes a binary recording, the timestamp column and the final header are written on `close()`
+     *
+     * the header's frame count is rewritten every `header_interval` frames, so an interrupted recording still
+     * reads as the frames up to the last rewrite. without the timestamp column they play at the header's fps.
+     */
+    class Writer
+    {
+    public:
+        static constexpr uint64_t header_interval = 64;
+
+        Writer(const std::string &file_name, uint32_t fps, bool with_timestamps);
+        ~Writer();
+
+        bool is_open() const;
+
+        /** @return false if writing failed, the recording is then incomplete */
+        bool write(const Snapshot &snapshot, Timestamp timestamp_us = 0);
+
+        /** @return false if writing failed or the writer wasn't open */
+        bool close();
+
+    private:
+        bool write_header(uint16_t flags);
+
+        std::ofstream output;
+        Header header;
+        std::vector<Timestamp> timestamps;
+    };
+
+    /** @brief convert a text recording (one snapshot per line) to the binary format
+     * @return the number of converted frames, nullopt on failure */
+    std::optional<uint64_t> convert_text_recording(const std::string &text_file_name, const std::string &binary_file_name, uint32_t fps);
+
+    /** @brief read all frames of a binary or text recording into memory
+     * @return nullopt if the file can't be read or a text line is malformed */
+    std::optional<std::vector<Snapshot>> load_snapshots(const std::string &file_name);
+};
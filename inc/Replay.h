@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "mapping_common.h"
+
+/**
+ * headless replay: maps whole recordings as fast as possible and writes the cursor streams.
+ * every recording is loaded and split into chunks by a task of its own, the chunks are mapped on a
+ * work-stealing pool, so a few long recordings spread over all cores as well as many short ones.
+ */
+namespace Replay {
+    enum class Strategy
+    {
+        Euclidean,
+        Perspective,
+        Both,
+    };
+
+    struct Options
+    {
+        std::vector<std::string> recordings;
+        std::string output_directory = ".";
+        Strategy strategy = Strategy::Both;
+        size_t threads = 1;
+        size_t chunk_frames = 2048;
+        ScreenCorners screen{1920, 1080};
+    };
+
+    struct Report
+    {
+        uint64_t recordings = 0;
+        uint64_t failed_recordings = 0; // couldn't be read or written
+        uint64_t frames = 0;
+        uint64_t mapped = 0;           // per strategy, a frame mapped by both strategies counts twice
+        uint64_t chunks = 0;
+        uint64_t stolen = 0;           // tasks run by another worker than the one they were queued on
+        size_t threads = 0;
+        double wall_seconds = 0;
+        double busy_seconds = 0;       // summed over the workers
+
+        double frames_per_second() const;
+        double frames_per_second_per_core() const;
+        std::string to_string() const;
+    };
+
+    /**
+     * @brief map every recording, `<output_directory>/<recording name>.cursors.csv` has one row per frame, in order
+     * the csv columns are `frame` and x,y per strategy, empty where the strategy failed on the frame.
+     * nothing is mapped if two recordings have the same name, they are reported as failed.
+     */
+    Report run(const Options &options);
+};
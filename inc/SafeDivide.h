@@ -1,13 +1,13 @@
 #pragma once
 
-#include <exception>
+#include "MappingError.h"
 
 template <typename T>
-T SafeDivide(T numerator, T denominator)
+MappingResult<T> SafeDivide(T numerator, T denominator)
 {
     if (denominator == 0)
     {
-        throw std::runtime_error("Division by zero");
+        return std::unexpected(MappingError::DivisionByZero);
     }
     return numerator / denominator;
 }
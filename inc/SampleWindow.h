@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief the most recent `MaxSamples` measurements, percentiles are only computed on demand
+ *
+ * adding a sample is a single store, so it can sit on a hot path (pacing, rendering, packet reception).
+ */
+template <size_t MaxSamples = 4096>
+class SampleWindow
+{
+public:
+    struct Percentiles
+    {
+        double p50 = 0;
+        double p99 = 0;
+        double max = 0;
+    };
+
+    void add(float sample)
+    {
+        samples[added % MaxSamples] = sample;
+        added++;
+    }
+
+    /** @brief number of samples added since the last `clear()`, including the ones that left the window */
+    uint64_t count() const { return added; }
+
+    void clear() { added = 0; }
+
+    Percentiles percentiles() const
+    {
+        Percentiles result;
+        if (added == 0)
+        {
+            return result;
+        }
+
+        std::vector<float> window(samples.begin(), samples.begin() + std::min<uint64_t>(added, MaxSamples));
+        auto percentile = [&window](double p) {
+            auto it = window.begin() + static_cast<size_t>(p * (window.size() - 1));
+            std::nth_element(window.begin(), it, window.end());
+            return static_cast<double>(*it);
+        };
+        result.p50 = percentile(0.5);
+        result.p99 = percentile(0.99);
+        result.max = *std::max_element(window.begin(), window.end());
+        return result;
+    }
+
+private:
+    std::array<float, MaxSamples> samples{};
+    uint64_t added = 0;
+};
@@ -1,9 +1,10 @@
 #pragma once
 
 #include <array>
+#include <expected>
 #include <stdint.h>
 #include <string>
-#include <sstream>
+#include <string_view>
 #include "consts.h"
 
 struct Point
@@ -14,14 +15,18 @@ struct Point
     std::string to_string() const;
 };
 
-struct PointF
+/** @brief a point in any scalar type the mapping is instantiated for (float, double, `Q16`) */
+template <typename T>
+struct BasicPoint
 {
-    float x;
-    float y;
+    T x;
+    T y;
 
     std::string to_string() const;
 };
 
+using PointF = BasicPoint<float>;
+
 Point point_from_string(const std::string &str);
 
 struct Snapshot
@@ -33,4 +38,38 @@ struct Snapshot
     bool is_valid() const;
 };
 
+/** @brief parse a snapshot, returns `Snapshot::invalid()` for malformed input */
 Snapshot snapshot_from_string(const std::string& input);
+
+enum class ParseError
+{
+    UnexpectedCharacter, // a bracket, parenthesis or comma is missing
+    InvalidNumber,       // a coordinate is not a number or doesn't fit in 16 bits
+    TrailingCharacters,  // anything but whitespace after the closing bracket
+};
+
+constexpr const char *to_string(ParseError error)
+{
+    switch (error)
+    {
+    case ParseError::UnexpectedCharacter:
+        return "unexpected character";
+    case ParseError::InvalidNumber:
+        return "invalid number";
+    case ParseError::TrailingCharacters:
+        return "trailing characters";
+    }
+    return "unknown error";
+}
+
+/** @brief allocation free parsing of the text format `[(x,y),(x,y),(x,y),(x,y)]`
+ * @note whitespace is allowed between tokens */
+std::expected<Snapshot, ParseError> parse_snapshot(std::string_view input);
+
+/** @brief the longest text a snapshot can be formatted to, every coordinate uses 5 digits */
+inline constexpr size_t snapshot_text_capacity = std::string_view("[(65535,65535),(65535,65535),(65535,65535),(65535,65535)]").size();
+using SnapshotTextBuffer = std::array<char, snapshot_text_capacity>;
+
+/** @brief allocation free formatting of a snapshot into a caller provided buffer
+ * @return a view of the formatted text, valid as long as `buffer` is */
+std::string_view format_snapshot(const Snapshot &snapshot, SnapshotTextBuffer &buffer);
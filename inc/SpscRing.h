@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+/**
+ * @brief lock-free single-producer single-consumer ring with a latest-wins overwrite policy
+ *
+ * the producer never blocks, every `push()` overwrites the oldest slot.
+ * the consumer only takes the most recent value, everything pushed before it is skipped.
+ * every slot is a small seqlock: the value is stored as atomic words between an odd (writing) and an even
+ * (written) slot sequence, a consumer that raced with an overwrite sees the sequence change and retries.
+ */
+template <typename T, size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity >= 2, "the consumer needs a slot the producer isn't writing to");
+    static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>, "values are copied word by word");
+
+public:
+    struct Item
+    {
+        T value;
+        uint64_t sequence; // number of pushes before this one
+    };
+
+    /** @brief producer side, never blocks */
+    void push(const T &value)
+    {
+        const uint64_t index = write_index.load(std::memory_order_relaxed);
+        Slot &slot = slots[index % Capacity];
+
+        Words words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        // release: a consumer that sees any new word also sees the odd sequence
+        for (size_t i = 0; i < word_count; i++)
+        {
+            slot.words[i].store(words[i], std::memory_order_release);
+        }
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+        write_index.store(index + 1, std::memory_order_release);
+    }
+
+    /** @brief consumer side, the latest value if anything was pushed since the last call */
+    std::optional<Item> pop_latest()
+    {
+        while (true)
+        {
+            const uint64_t end = write_index.load(std::memory_order_acquire);
+            if (end == read_index)
+            {
+                return std::nullopt;
+            }
+
+            const uint64_t index = end - 1;
+            const Slot &slot = slots[index % Capacity];
+            if (slot.sequence.load(std::memory_order_acquire) != 2 * index + 2)
+            {
+                // already being overwritten by a newer push
+                continue;
+            }
+
+            Words words;
+            for (size_t i = 0; i < word_count; i++)
+            {
+                words[i] = slot.words[i].load(std::memory_order_acquire);
+            }
+            if (slot.sequence.load(std::memory_order_relaxed) != 2 * index + 2)
+            {
+                continue;
+            }
+
+            Item item{T{}, index};
+            std::memcpy(static_cast<void *>(&item.value), words.data(), sizeof(T));
+            read_index = end;
+            return item;
+        }
+    }
+
+    /** @brief total number of pushes */
+    uint64_t pushed() const { return write_index.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t word_count = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    using Words = std::array<uint64_t, word_count>;
+
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence{0};
+        std::array<std::atomic<uint64_t>, word_count> words{};
+    };
+
+    // producer and consumer state on separate cache lines
+    alignas(64) std::atomic<uint64_t> write_index{0};
+    alignas(64) uint64_t read_index = 0;
+    alignas(64) std::array<Slot, Capacity> slots{};
+};
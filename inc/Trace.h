@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#ifndef LIGHTGUN_TRACING
+#define LIGHTGUN_TRACING 0
+#endif
+
+/**
+ * per-stage trace spans, exported as Chrome trace JSON (open in chrome://tracing or ui.perfetto.dev).
+ *
+ * `TRACE_SPAN("name")` times the rest of the enclosing scope. every thread writes its spans into its own ring
+ * (allocated on the thread's first span), so a span costs two clock reads and a few relaxed stores, without
+ * locks or allocation. a full ring overwrites its oldest spans.
+ * the spans are compiled out unless the build defines `LIGHTGUN_TRACING=1` (cmake -DLIGHTGUN_TRACING=ON).
+ */
+namespace Trace {
+    inline constexpr bool enabled = LIGHTGUN_TRACING;
+    inline constexpr size_t ring_capacity = 1 << 15; // spans kept per thread
+
+    using clock = std::chrono::steady_clock;
+
+    /** @brief record a span of the calling thread, `name` must outlive the trace (a string literal) */
+    void record(const char *name, clock::time_point begin, clock::time_point end);
+
+    /** @brief name the calling thread in the trace, `name` must outlive the trace */
+    void set_thread_name(const char *name);
+
+    /** @brief write the spans of all threads as Chrome trace JSON, other threads can keep recording meanwhile */
+    bool write_chrome_trace(const std::string &path);
+
+    /** @brief write the trace to `path` when the process exits and every time it receives SIGUSR1
+     * @note call before any other thread is started, SIGUSR1 is only blocked in the threads started afterwards */
+    void dump_on_exit_and_signal(const std::string &path);
+
+    class Span
+    {
+    public:
+        explicit Span(const char *name) : name(name), begin(clock::now()) {}
+        ~Span() { record(name, begin, clock::now()); }
+
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+
+    private:
+        const char *name;
+        clock::time_point begin;
+    };
+};
+
+#if LIGHTGUN_TRACING
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SPAN(name) const Trace::Span TRACE_CONCAT(trace_span_, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) static_cast<void>(0)
+#endif
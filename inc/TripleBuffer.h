@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief lock-free single-producer single-consumer handover of the latest value
+ *
+ * the producer and the consumer each own one of the 3 slots, the third is the one in the middle.
+ * publishing swaps the producer's slot into the middle, updating swaps the middle into the consumer's slot,
+ * so neither side ever waits or copies, and the consumer always reads a complete value.
+ * unlike `SpscRing` the value doesn't have to be trivially copyable.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    /** @brief producer side, the slot to fill before `publish()` */
+    T &write_buffer() { return slots[write_index]; }
+
+    /** @brief producer side, hand the filled slot over, an unconsumed value in the middle is overwritten */
+    void publish()
+    {
+        // release: the consumer that takes the slot sees everything written to it
+        auto previous = middle.exchange(write_index | new_value_bit, std::memory_order_acq_rel);
+        write_index = previous & index_mask;
+    }
+
+    /** @brief consumer side, take the latest published value
+     * @return false if nothing was published since the last update, `read_buffer()` is unchanged */
+    bool update()
+    {
+        if ((middle.load(std::memory_order_relaxed) & new_value_bit) == 0)
+        {
+            return false;
+        }
+        // acquire: see everything the producer wrote to the slot before publishing it
+        auto previous = middle.exchange(read_index, std::memory_order_acq_rel);
+        read_index = previous & index_mask;
+        return true;
+    }
+
+    /** @brief consumer side, the value taken by the last successful `update()` */
+    const T &read_buffer() const { return slots[read_index]; }
+
+private:
+    static constexpr uint8_t index_mask = 0b011;
+    static constexpr uint8_t new_value_bit = 0b100;
+
+    std::array<T, 3> slots{};
+    alignas(64) std::atomic<uint8_t> middle{1};
+    alignas(64) uint8_t write_index = 0; // producer only
+    alignas(64) uint8_t read_index = 2;  // consumer only
+};
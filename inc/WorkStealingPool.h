@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief a fixed set of worker threads with a task deque each
+ *
+ * a worker pops its newest task first (its data is still in cache), an idle worker steals the oldest task of
+ * another worker (the biggest remaining piece of work), so uneven tasks still spread over all workers.
+ * tasks are coarse (a chunk of frames), a mutex per deque is cheap at that granularity. a worker that finds
+ * nothing to steal parks until a task is spawned or the last one finished.
+ */
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    struct WorkerStats
+    {
+        uint64_t executed = 0;
+        uint64_t stolen = 0;            // executed tasks taken from another worker
+        std::chrono::nanoseconds busy{}; // time spent in tasks
+    };
+
+    explicit WorkStealingPool(size_t thread_count);
+
+    /** @brief run `tasks` and everything they `spawn()`, returns when all of them are done */
+    void run(std::vector<Task> tasks);
+
+    /** @brief queue a task on the calling worker's deque, only valid inside a running task */
+    void spawn(Task task);
+
+    size_t thread_count() const;
+    const std::vector<WorkerStats> &stats() const;
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void work(size_t index);
+    bool pop(size_t index, Task &task);
+    bool steal(size_t index, Task &task);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<WorkerStats> worker_stats;
+    std::atomic<uint64_t> pending{0}; // queued and running tasks
+    std::atomic<uint32_t> queued{0};  // bumped when a task is spawned or the last one finished, parked workers wait on it
+};
@@ -2,6 +2,7 @@
 
 #include <optional>
 #include "Geometry.h"
+#include "MappingError.h"
 
 struct screen_constants
 {
@@ -15,18 +16,37 @@ struct screen_constants
     }
 };
 
-struct ScreenCorners
+template <typename T>
+struct BasicScreenCorners
 {
-    ScreenCorners(float width, float height)
-        : top_left(0, 0), top_right(width, 0), bot_left(0, height), bot_right(width, height) {}
+    BasicScreenCorners(T width, T height)
+        : top_left(T(0), T(0)), top_right(width, T(0)), bot_left(T(0), height), bot_right(width, height) {}
 
-    ScreenCorners(PointF tl, PointF tr, PointF bl, PointF br)
+    BasicScreenCorners(BasicPoint<T> tl, BasicPoint<T> tr, BasicPoint<T> bl, BasicPoint<T> br)
         : top_left(tl), top_right(tr), bot_left(bl), bot_right(br) {}
 
-    PointF top_left;
-    PointF top_right;
-    PointF bot_left;
-    PointF bot_right;
+    BasicPoint<T> top_left;
+    BasicPoint<T> top_right;
+    BasicPoint<T> bot_left;
+    BasicPoint<T> bot_right;
 };
 
-std::optional<ScreenCorners> calculate_screen_corners(const Snapshot &snapshot);
+using ScreenCorners = BasicScreenCorners<float>;
+
+/*
+the corner functions are templated on the scalar type and instantiated in mapping_common.cpp for float, double
+and `Q16` (see FixedPoint.h). the lines through the IR points multiply coordinates, which overflows `Q16` in camera
+units, so a fixed point caller scales the classified corners down before `calculate_screen_corners`
+(there is no `Q16` instance of the `Snapshot` overload)
+*/
+
+/** @brief assign the 4 IR points to the corner of the quad they lie in, relative to their average point */
+template <typename T = float>
+MappingResult<BasicScreenCorners<T>> classify_ir_corners(const Snapshot &snapshot);
+
+/** @brief the screen corners in camera space, from the IR points assigned to their corners */
+template <typename T>
+MappingResult<BasicScreenCorners<T>> calculate_screen_corners(const BasicScreenCorners<T> &ir_corners);
+
+template <typename T = float>
+MappingResult<BasicScreenCorners<T>> calculate_screen_corners(const Snapshot &snapshot);
@@ -3,26 +3,67 @@
 #include <SDL2/SDL.h>
 #include <vector>
 #include <string>
+#include <string_view>
 
+/**
+ * @brief draws the queued pixels and segments every frame
+ *
+ * the rects are submitted with one `SDL_RenderFillRectsF` call per run of equally colored pixels (a single call
+ * unless several colors are queued), the segments as lines that SDL's command queue batches. the rect buffer
+ * persists across frames so steady state rendering doesn't allocate.
+ */
 class Screen
 {
 public:
-    static Screen *create(const char *title, int width, int height, float scale = 1.0f);
+    static constexpr SDL_Color default_color = {255, 255, 255, 255};
+
+    /** @param vsync present at the display refresh, `render_screen()` blocks until the next vertical blank */
+    static Screen *create(const char *title, int width, int height, float scale = 1.0f, bool vsync = true);
+
+    /** @brief render with the software renderer into an offscreen surface, no display or window needed */
+    static Screen *create_headless(int width, int height, float scale = 1.0f);
     ~Screen();
 
-    void add_pixel(SDL_FPoint point);
-    void add_segment(std::pair<SDL_FPoint, SDL_FPoint> segment);
+    /** @note queue the pixels of one color together, every change of color between queued pixels costs a draw call */
+    void add_pixel(SDL_FPoint point, SDL_Color color = default_color);
+    void add_segment(std::pair<SDL_FPoint, SDL_FPoint> segment, SDL_Color color = default_color);
     void clear_pixels();
     void clear_segments();
     void render_screen();
-    void input();
+    /** @brief handle the pending window events, waiting up to `wait_ms` for the first one
+     * @return false once the window was closed */
+    bool input(int wait_ms = 0);
+
+    /** @brief text drawn over the frame while the overlay is visible, `\n` separated lines
+     * @note only digits, upper case letters and `. : / - %` are drawn, anything else is a blank */
+    void set_overlay_text(std::string_view text);
+    /** @brief toggled with F3 */
+    bool overlay_visible() const { return show_overlay; }
+    void toggle_overlay() { show_overlay = !show_overlay; }
+
+    /** @brief refresh rate of the window's display in Hz, 0 if unknown (e.g. headless) */
+    int refresh_rate() const;
+
+    /** @brief the offscreen render target, nullptr unless headless */
+    const SDL_Surface *surface() const;
 
 private:
-    Screen(SDL_Window *window, SDL_Renderer *renderer);
+    Screen(SDL_Window *window, SDL_Renderer *renderer, SDL_Surface *surface = nullptr);
     void clear_screen();
+    void build_rects();
     SDL_Event event;
     SDL_Window *window;
     SDL_Renderer *renderer;
+    SDL_Surface *offscreen;
     std::vector<SDL_FPoint> points;
+    std::vector<SDL_Color> point_colors;
     std::vector<std::pair<SDL_FPoint, SDL_FPoint>> segments;
+    std::vector<SDL_Color> segment_colors;
+
+    // submission buffer, rebuilt every frame
+    std::vector<SDL_FRect> rects;
+
+    // the overlay text as rects, rebuilt only when the text changes
+    bool show_overlay = false;
+    std::vector<SDL_FRect> overlay_rects;
 };
@@ -0,0 +1,106 @@
+#include "AcquisitionThread.h"
+#include "Trace.h"
+
+AcquisitionThread::AcquisitionThread(IDataAcq *data_acq, LiveStats *live_stats)
+    : data_acq(data_acq),
+      live_stats(live_stats),
+      thread([this](std::stop_token stop_token) { run(stop_token); })
+{
+}
+
+AcquisitionThread::~AcquisitionThread()
+{
+    stop();
+}
+
+void AcquisitionThread::stop()
+{
+    if (thread.joinable())
+    {
+        thread.request_stop();
+        thread.join();
+    }
+}
+
+void AcquisitionThread::run(std::stop_token stop_token)
+{
+    Trace::set_thread_name("acquisition");
+    while (!stop_token.stop_requested())
+    {
+        const auto start = clock::now();
+        auto snapshot = data_acq->get();
+        const auto capture_time = clock::now();
+        if (live_stats != nullptr)
+        {
+            live_stats->acquisition.record(capture_time - start);
+        }
+        ring.push(Frame{snapshot, capture_time});
+        wake_consumer();
+    }
+}
+
+void AcquisitionThread::wake_consumer()
+{
+    wakeups.fetch_add(1, std::memory_order_release);
+    wakeups.notify_one();
+}
+
+std::optional<AcquisitionThread::Frame> AcquisitionThread::wait_latest(std::stop_token stop_token)
+{
+    std::stop_callback wake_on_stop(stop_token, [this] { wake_consumer(); });
+    bool woken = false;
+    while (!stop_token.stop_requested())
+    {
+        // read before checking the ring, a push after the check changes it and the wait returns at once
+        const uint32_t seen = wakeups.load(std::memory_order_acquire);
+        if (auto frame = latest(); frame.has_value())
+        {
+            return frame;
+        }
+        if (woken)
+        {
+            stale++;
+        }
+        wakeups.wait(seen, std::memory_order_acquire);
+        woken = true;
+    }
+    return std::nullopt;
+}
+
+std::optional<AcquisitionThread::Frame> AcquisitionThread::latest()
+{
+    auto item = ring.pop_latest();
+    if (!item.has_value())
+    {
+        return std::nullopt;
+    }
+
+    // every frame between the last consumed frame and this one was overwritten
+    dropped += item->sequence - next_sequence;
+    next_sequence = item->sequence + 1;
+
+    const auto &snapshot = item->value.snapshot;
+    auto same_points = [](const Snapshot &lhs, const Snapshot &rhs) {
+        for (size_t i = 0; i < lhs.points.size(); i++)
+        {
+            if (lhs.points[i].x != rhs.points[i].x || lhs.points[i].y != rhs.points[i].y)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (previous.has_value() && same_points(previous.value(), snapshot))
+    {
+        duplicate++;
+    }
+    previous = snapshot;
+    consumed++;
+
+    return item->value;
+}
+
+AcquisitionThread::Stats AcquisitionThread::stats() const
+{
+    return Stats{ring.pushed(), consumed, dropped, stale, duplicate};
+}
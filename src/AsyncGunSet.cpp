@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <cstdio>
+#include "AsyncGunSet.h"
+
+AsyncGunSet::Gun::Gun(const GunSet::Params &params)
+    : mapper(params.screen_corners, params.debug_mode, params.reuse_tolerance, make_cursor_filter(params.filter),
+             params.track_partial_visibility, &stats)
+{
+}
+
+AsyncGunSet::AsyncGunSet(EventLoop &loop, std::span<IAsyncDataAcq *const> sources, const GunSet::Params &params)
+    : ready(loop), debug_mode(params.debug_mode)
+{
+    const size_t count = std::min(sources.size(), GunSet::max_guns);
+    guns.reserve(count);
+    for (size_t gun = 0; gun < count; gun++)
+    {
+        guns.push_back(std::make_unique<Gun>(params));
+        loop.spawn(run(loop, *guns.back(), sources[gun]));
+    }
+}
+
+bool AsyncGunSet::update()
+{
+    bool any = false;
+    for (auto &gun : guns)
+    {
+        gun->fresh = std::exchange(gun->mapped, false);
+        any = any || gun->fresh;
+    }
+    return any;
+}
+
+Task<void> AsyncGunSet::run(EventLoop &loop, Gun &gun, IAsyncDataAcq *source)
+{
+    while (true)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        auto snapshot = co_await source->get_async(loop);
+        const auto capture_time = std::chrono::steady_clock::now();
+        gun.stats.acquisition.record(capture_time - start);
+
+        if (debug_mode)
+        {
+            printf("Snapshot: %s\n", snapshot.to_string().c_str());
+        }
+        gun.mapper.map(snapshot, capture_time, gun.frame);
+        gun.mapped = true;
+        ready.notify();
+    }
+}
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cmath>
+
+#include "CachedPerspectiveMapper.h"
+
+namespace LinAlgPointMapping {
+    CachedPerspectiveMapper::CachedPerspectiveMapper(float tolerance, bool measure_error)
+        : _tolerance_squared(tolerance * tolerance),
+          _measure_error(measure_error)
+    {
+    }
+
+    void CachedPerspectiveMapper::reset()
+    {
+        _stats = {};
+        _transform.reset();
+    }
+
+    bool CachedPerspectiveMapper::can_reuse(const Snapshot &src, const ScreenCorners &dst_corners) const
+    {
+        if (!_transform.has_value())
+        {
+            return false;
+        }
+
+        auto same_point = [](const PointF &lhs, const PointF &rhs) { return lhs.x == rhs.x && lhs.y == rhs.y; };
+        if (!same_point(_dst_corners.top_left, dst_corners.top_left) || !same_point(_dst_corners.top_right, dst_corners.top_right) ||
+            !same_point(_dst_corners.bot_left, dst_corners.bot_left) || !same_point(_dst_corners.bot_right, dst_corners.bot_right))
+        {
+            return false;
+        }
+
+        // the camera keeps the IR points in stable slots, so compare point by point
+        for (size_t i = 0; i < dfrobot_snapshot_size; i++)
+        {
+            const float dx = static_cast<float>(src.points[i].x) - static_cast<float>(_reference.points[i].x);
+            const float dy = static_cast<float>(src.points[i].y) - static_cast<float>(_reference.points[i].y);
+            if (dx * dx + dy * dy > _tolerance_squared)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::optional<PointF> CachedPerspectiveMapper::map_snapshot_to_cursor(const Snapshot &src, const ScreenCorners &dst_corners)
+    {
+        _stats.frames++;
+
+        if (!src.is_valid())
+        {
+            _stats.invalid++;
+            return std::nullopt;
+        }
+
+        if (can_reuse(src, dst_corners))
+        {
+            auto cursor = map_camera_center(_transform.value());
+            _stats.reused++;
+
+            if (_measure_error && cursor.has_value())
+            {
+                auto exact = LinAlgPointMapping::map_snapshot_to_cursor(src, dst_corners);
+                if (exact.has_value())
+                {
+                    const float error = std::hypot(exact->x - cursor->x, exact->y - cursor->y);
+                    _stats.max_error = std::max(_stats.max_error, error);
+                }
+            }
+            return cursor;
+        }
+
+        auto opt_corners = calculate_screen_corners(src);
+        if (!opt_corners.has_value())
+        {
+            _stats.invalid++;
+            return std::nullopt;
+        }
+
+        auto opt_transform = getPerspectiveTransform(opt_corners.value(), dst_corners);
+        if (!opt_transform.has_value())
+        {
+            _stats.invalid++;
+            return std::nullopt;
+        }
+
+        _stats.solved++;
+        _transform = opt_transform;
+        _reference = src;
+        _dst_corners = dst_corners;
+        return map_camera_center(_transform.value());
+    }
+}
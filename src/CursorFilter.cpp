@@ -0,0 +1,130 @@
+#include <cmath>
+#include <numbers>
+#include "CursorFilter.h"
+
+namespace
+{
+    // seconds since the last measurement, nullopt if the filter has to restart
+    std::optional<float> elapsed_seconds(std::optional<std::chrono::nanoseconds> &last_time, std::chrono::nanoseconds time)
+    {
+        auto previous = last_time;
+        last_time = time;
+        if (!previous.has_value() || time <= previous.value() || time - previous.value() > ICursorFilter::reset_gap)
+        {
+            return std::nullopt;
+        }
+        return std::chrono::duration<float>(time - previous.value()).count();
+    }
+
+    // smoothing factor of an exponential low pass with the given cutoff
+    float low_pass_alpha(float cutoff_hz, float dt)
+    {
+        float tau = 1.0f / (2.0f * std::numbers::pi_v<float> * cutoff_hz);
+        return 1.0f / (1.0f + tau / dt);
+    }
+}
+
+OneEuroFilter::OneEuroFilter()
+    : OneEuroFilter(Params{})
+{
+}
+
+OneEuroFilter::OneEuroFilter(Params params)
+    : params(params)
+{
+}
+
+void OneEuroFilter::reset()
+{
+    last_time.reset();
+}
+
+PointF OneEuroFilter::filter(const PointF &measurement, std::chrono::nanoseconds time)
+{
+    const std::array<float, 2> values{measurement.x, measurement.y};
+    auto dt = elapsed_seconds(last_time, time);
+    if (!dt.has_value())
+    {
+        axes = {Axis{values[0], 0}, Axis{values[1], 0}};
+        return measurement;
+    }
+
+    for (size_t i = 0; i < axes.size(); i++)
+    {
+        auto &axis = axes[i];
+        float derivative = (values[i] - axis.value) / dt.value();
+        axis.derivative += low_pass_alpha(params.derivative_cutoff_hz, dt.value()) * (derivative - axis.derivative);
+
+        float cutoff = params.min_cutoff_hz + params.beta * std::abs(axis.derivative);
+        axis.value += low_pass_alpha(cutoff, dt.value()) * (values[i] - axis.value);
+    }
+    return {axes[0].value, axes[1].value};
+}
+
+KalmanFilter::KalmanFilter()
+    : KalmanFilter(Params{})
+{
+}
+
+KalmanFilter::KalmanFilter(Params params)
+    : params(params)
+{
+}
+
+void KalmanFilter::reset()
+{
+    last_time.reset();
+}
+
+void KalmanFilter::update(Axis &axis, float measurement, float dt) const
+{
+    // predict: x = F x, P = F P F' + Q, with F = [1 dt; 0 1] and Q the white acceleration noise over dt
+    axis.position += axis.velocity * dt;
+    const float q = params.process_noise;
+    const float dt2 = dt * dt;
+    float p00 = axis.p00 + dt * (2 * axis.p01 + dt * axis.p11) + q * dt2 * dt / 3;
+    float p01 = axis.p01 + dt * axis.p11 + q * dt2 / 2;
+    float p11 = axis.p11 + q * dt;
+
+    // correct with the measured position, H = [1 0]
+    const float innovation = measurement - axis.position;
+    const float s = p00 + params.measurement_noise;
+    const float k0 = p00 / s;
+    const float k1 = p01 / s;
+    axis.position += k0 * innovation;
+    axis.velocity += k1 * innovation;
+    axis.p00 = (1 - k0) * p00;
+    axis.p01 = (1 - k0) * p01;
+    axis.p11 = p11 - k1 * p01;
+}
+
+PointF KalmanFilter::filter(const PointF &measurement, std::chrono::nanoseconds time)
+{
+    auto dt = elapsed_seconds(last_time, time);
+    if (!dt.has_value())
+    {
+        // start at the measurement with an unknown velocity
+        const float velocity_variance = 1e6f;
+        axes[0] = {measurement.x, 0, params.measurement_noise, 0, velocity_variance};
+        axes[1] = {measurement.y, 0, params.measurement_noise, 0, velocity_variance};
+        return measurement;
+    }
+
+    update(axes[0], measurement.x, dt.value());
+    update(axes[1], measurement.y, dt.value());
+    return {axes[0].position, axes[1].position};
+}
+
+std::unique_ptr<ICursorFilter> make_cursor_filter(const CursorFilterConfig &config)
+{
+    switch (config.type)
+    {
+    case FilterType::None:
+        return nullptr;
+    case FilterType::OneEuro:
+        return std::make_unique<OneEuroFilter>(config.one_euro);
+    case FilterType::Kalman:
+        return std::make_unique<KalmanFilter>(config.kalman);
+    }
+    return nullptr;
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cmath>
+#include "CursorPredictor.h"
+
+CursorPredictor::CursorPredictor(PointF screen_size)
+    : CursorPredictor(Params{}, screen_size)
+{
+}
+
+CursorPredictor::CursorPredictor(Params params, PointF screen_size)
+    : params(params),
+      screen_size(screen_size)
+{
+    this->params.history = std::clamp<size_t>(params.history, 2, max_history);
+}
+
+void CursorPredictor::reset()
+{
+    count = 0;
+    velocity = {0, 0};
+    last_step = 0;
+}
+
+void CursorPredictor::add(const PointF &measurement, std::chrono::nanoseconds time)
+{
+    if (count > 0)
+    {
+        auto previous = samples[newest].time;
+        if (time <= previous || time - previous > reset_gap)
+        {
+            // the target was lost for a while, don't fit across the gap
+            reset();
+        }
+    }
+
+    if (count > 0)
+    {
+        const auto &previous = samples[newest].position;
+        last_step = std::hypot(measurement.x - previous.x, measurement.y - previous.y);
+    }
+    newest = (newest + 1) % max_history;
+    samples[newest] = {measurement, time};
+    count = std::min(count + 1, params.history);
+
+    // least squares slope over the last `count` samples, times relative to the newest to keep the floats small
+    float mean_t = 0, mean_x = 0, mean_y = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto &sample = samples[(newest + max_history - i) % max_history];
+        mean_t += std::chrono::duration<float>(sample.time - time).count();
+        mean_x += sample.position.x;
+        mean_y += sample.position.y;
+    }
+    mean_t /= count;
+    mean_x /= count;
+    mean_y /= count;
+
+    float stt = 0, stx = 0, sty = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto &sample = samples[(newest + max_history - i) % max_history];
+        float t = std::chrono::duration<float>(sample.time - time).count() - mean_t;
+        stt += t * t;
+        stx += t * (sample.position.x - mean_x);
+        sty += t * (sample.position.y - mean_y);
+    }
+    velocity = stt > 0 ? PointF{stx / stt, sty / stt} : PointF{0, 0};
+}
+
+std::optional<PointF> CursorPredictor::predict(std::chrono::nanoseconds time) const
+{
+    if (count == 0)
+    {
+        return std::nullopt;
+    }
+
+    const auto &last = samples[newest];
+    auto horizon = std::clamp<std::chrono::nanoseconds>(time - last.time, std::chrono::nanoseconds(0), params.max_horizon);
+    float seconds = std::chrono::duration<float>(horizon).count();
+    float dx = velocity.x * seconds;
+    float dy = velocity.y * seconds;
+
+    // a sudden stop would otherwise overshoot by the whole extrapolation, bound it by the movement actually measured
+    float distance = std::hypot(dx, dy);
+    float max_distance = params.max_step_ratio * last_step;
+    if (distance > max_distance)
+    {
+        float scale = distance > 0 ? max_distance / distance : 0;
+        dx *= scale;
+        dy *= scale;
+    }
+
+    // don't extrapolate off the screen, but don't pull an off screen measurement back either
+    float x = std::clamp(last.position.x + dx, std::min(0.0f, last.position.x), std::max(screen_size.x, last.position.x));
+    float y = std::clamp(last.position.y + dy, std::min(0.0f, last.position.y), std::max(screen_size.y, last.position.y));
+    return PointF{x, y};
+}
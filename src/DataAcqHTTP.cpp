@@ -1,24 +1,350 @@
 #include "DataAcqHTTP.h"
+#include "Trace.h"
 
-#include <cpr/api.h>
+#include <array>
+#include <cerrno>
+#include <curl/curl.h>
 #include <iostream>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <thread>
+#include <unistd.h>
 
+struct DataAcqHTTP::Multi
+{
+    CURLM *handle;
+    int watch_fd = -1; // epoll set of curl's sockets and `timer_fd`, waited on by `get_async`
+    int timer_fd = -1; // curl's timeout
+
+    Multi()
+    {
+        // not thread-safe before curl 7.84, the sources are constructed on the main thread
+        static const bool initialized = curl_global_init(CURL_GLOBAL_DEFAULT) == CURLE_OK;
+        handle = initialized ? curl_multi_init() : nullptr;
+
+        watch_fd = epoll_create1(EPOLL_CLOEXEC);
+        timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = timer_fd;
+        if (handle == nullptr || watch_fd < 0 || timer_fd < 0 || epoll_ctl(watch_fd, EPOLL_CTL_ADD, timer_fd, &event) != 0)
+        {
+            // `get` still works with curl's own polling
+            close_watch();
+            return;
+        }
+        curl_multi_setopt(handle, CURLMOPT_SOCKETFUNCTION, watch_socket);
+        curl_multi_setopt(handle, CURLMOPT_SOCKETDATA, this);
+        curl_multi_setopt(handle, CURLMOPT_TIMERFUNCTION, arm_timer);
+        curl_multi_setopt(handle, CURLMOPT_TIMERDATA, this);
+    }
+    ~Multi()
+    {
+        // the cleanup still reports the removed sockets
+        curl_multi_cleanup(handle);
+        close_watch();
+    }
+
+    void close_watch()
+    {
+        for (int *fd : {&watch_fd, &timer_fd})
+        {
+            if (*fd >= 0)
+            {
+                ::close(*fd);
+                *fd = -1;
+            }
+        }
+    }
+
+    // level-triggered, a socket stays ready until `curl_multi_socket_action` consumed it
+    static int watch_socket(CURL *, curl_socket_t socket, int what, void *multi, void *)
+    {
+        const int watch_fd = static_cast<Multi *>(multi)->watch_fd;
+        if (what == CURL_POLL_REMOVE)
+        {
+            epoll_ctl(watch_fd, EPOLL_CTL_DEL, socket, nullptr);
+            return 0;
+        }
+        epoll_event event{};
+        if (what & CURL_POLL_IN)
+        {
+            event.events |= EPOLLIN;
+        }
+        if (what & CURL_POLL_OUT)
+        {
+            event.events |= EPOLLOUT;
+        }
+        event.data.fd = socket;
+        if (epoll_ctl(watch_fd, EPOLL_CTL_MOD, socket, &event) != 0 && errno == ENOENT)
+        {
+            epoll_ctl(watch_fd, EPOLL_CTL_ADD, socket, &event);
+        }
+        return 0;
+    }
 
-DataAcqHTTP::DataAcqHTTP(const std::string &esp_server_ip)
-    : esp_server_ip(esp_server_ip)
+    static int arm_timer(CURLM *, long timeout_ms, void *multi)
+    {
+        // -1 disarms, 0 is due at once (an all zero `it_value` would disarm instead)
+        itimerspec spec{};
+        if (timeout_ms >= 0)
+        {
+            spec.it_value.tv_sec = timeout_ms / 1000;
+            spec.it_value.tv_nsec = std::max<long>((timeout_ms % 1000) * 1'000'000, 1);
+        }
+        timerfd_settime(static_cast<Multi *>(multi)->timer_fd, 0, &spec, nullptr);
+        return 0;
+    }
+};
+
+struct DataAcqHTTP::Request
 {
+    CURL *easy = nullptr;
+    std::string body;
+    std::optional<CURLcode> result; // set once the transfer finished
+};
+
+namespace
+{
+    // while failing, e.g. a refused connection fails at once and would otherwise be retried in a busy loop
+    constexpr std::chrono::milliseconds retry_delay(50);
+
+    size_t append_body(char *data, size_t size, size_t count, void *body)
+    {
+        static_cast<std::string *>(body)->append(data, size * count);
+        return size * count;
+    }
 }
 
-DataAcqHTTP::~DataAcqHTTP() = default;
+DataAcqHTTP::DataAcqHTTP(const std::string &esp_server_ip, size_t pipeline_depth, std::chrono::milliseconds timeout)
+    : esp_server_ip(esp_server_ip),
+      timeout(timeout),
+      multi(std::make_unique<Multi>()),
+      requests(std::max<size_t>(pipeline_depth, 1))
+{
+    if (multi->handle == nullptr)
+    {
+        report_failure("curl initialization failed");
+        return;
+    }
+    // one connection per slot, and a cache large enough to keep all of them while their handles are re-added
+    curl_multi_setopt(multi->handle, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(requests.size()));
+    curl_multi_setopt(multi->handle, CURLMOPT_MAXCONNECTS, static_cast<long>(requests.size()));
+
+    for (auto &request : requests)
+    {
+        request.easy = curl_easy_init();
+        curl_easy_setopt(request.easy, CURLOPT_URL, esp_server_ip.c_str());
+        curl_easy_setopt(request.easy, CURLOPT_TIMEOUT_MS, static_cast<long>(timeout.count()));
+        curl_easy_setopt(request.easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(request.easy, CURLOPT_TCP_NODELAY, 1L);
+        curl_easy_setopt(request.easy, CURLOPT_WRITEFUNCTION, append_body);
+        curl_easy_setopt(request.easy, CURLOPT_WRITEDATA, &request.body);
+        curl_easy_setopt(request.easy, CURLOPT_PRIVATE, &request);
+        issue(request);
+    }
+}
+
+DataAcqHTTP::~DataAcqHTTP()
+{
+    for (auto &request : requests)
+    {
+        if (request.easy == nullptr)
+        {
+            continue;
+        }
+        if (!request.result.has_value())
+        {
+            curl_multi_remove_handle(multi->handle, request.easy);
+        }
+        curl_easy_cleanup(request.easy);
+    }
+}
+
+void DataAcqHTTP::issue(Request &request)
+{
+    request.body.clear();
+    request.result.reset();
+    curl_multi_add_handle(multi->handle, request.easy);
+}
+
+DataAcqHTTP::Request &DataAcqHTTP::next()
+{
+    // the oldest request in flight, its handle is reused for a new one once it is taken
+    Request &request = requests[next_request];
+    next_request = (next_request + 1) % requests.size();
+    return request;
+}
+
+void DataAcqHTTP::wait_for(const Request &request)
+{
+    // every transfer progresses while waiting, not only the awaited one
+    while (!request.result.has_value())
+    {
+        int running = 0;
+        curl_multi_perform(multi->handle, &running);
+        collect_done();
+
+        if (!request.result.has_value())
+        {
+            curl_multi_poll(multi->handle, nullptr, 0, static_cast<int>(timeout.count()), nullptr);
+        }
+    }
+}
+
+void DataAcqHTTP::perform_ready()
+{
+    // without waiting, `get_async` waits for the whole set on the event loop
+    std::array<epoll_event, 8> events;
+    const int count = epoll_wait(multi->watch_fd, events.data(), static_cast<int>(events.size()), 0);
+    int running = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const int fd = events[i].data.fd;
+        if (fd == multi->timer_fd)
+        {
+            uint64_t expirations = 0;
+            while (::read(fd, &expirations, sizeof(expirations)) > 0) {}
+            curl_multi_socket_action(multi->handle, CURL_SOCKET_TIMEOUT, 0, &running);
+            continue;
+        }
+        const uint32_t ready = events[i].events;
+        const int mask = ((ready & EPOLLIN) ? CURL_CSELECT_IN : 0) | ((ready & EPOLLOUT) ? CURL_CSELECT_OUT : 0) |
+                         ((ready & (EPOLLERR | EPOLLHUP)) ? CURL_CSELECT_ERR : 0);
+        curl_multi_socket_action(multi->handle, fd, mask, &running);
+    }
+    collect_done();
+}
+
+void DataAcqHTTP::collect_done()
+{
+    int queued = 0;
+    while (CURLMsg *message = curl_multi_info_read(multi->handle, &queued))
+    {
+        if (message->msg != CURLMSG_DONE)
+        {
+            continue;
+        }
+        Request *done = nullptr;
+        curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &done);
+        done->result = message->data.result;
+        curl_multi_remove_handle(multi->handle, message->easy_handle);
+    }
+}
+
+void DataAcqHTTP::report_failure(const std::string &reason)
+{
+    _stats.failures++;
+    // log once per streak of failures instead of on every frame
+    if (!failing)
+    {
+        std::cerr << "Failed to fetch data from " << esp_server_ip << ": " << reason << std::endl;
+        failing = true;
+    }
+}
 
 Snapshot DataAcqHTTP::get()
 {
-    // try fetching from the esp32 server
-    cpr::Response r = cpr::Get(cpr::Url{esp_server_ip});
-    if (r.status_code != 200)
+    TRACE_SPAN("DataAcqHTTP::get");
+    if (multi->handle == nullptr)
+    {
+        return Snapshot::invalid();
+    }
+
+    Request &request = next();
+    wait_for(request);
+    auto snapshot = take(request);
+    if (failing)
+    {
+        std::this_thread::sleep_for(retry_delay);
+    }
+    return snapshot;
+}
+
+Task<Snapshot> DataAcqHTTP::get_async(EventLoop &loop)
+{
+    if (multi->handle == nullptr || multi->watch_fd < 0)
+    {
+        // every call fails, without a wait the other tasks wouldn't get a turn
+        co_await loop.sleep_until(EventLoop::clock::now() + retry_delay);
+        co_return Snapshot::invalid();
+    }
+
+    // like `wait_for`, every transfer progresses while waiting
+    Request &request = next();
+    perform_ready();
+    while (!request.result.has_value())
+    {
+        co_await loop.readable(multi->watch_fd);
+        perform_ready();
+    }
+    auto snapshot = take(request);
+    if (failing)
+    {
+        // a request that failed before any wait would never give the other tasks a turn
+        co_await loop.sleep_until(EventLoop::clock::now() + retry_delay);
+    }
+    co_return snapshot;
+}
+
+Snapshot DataAcqHTTP::take(Request &request)
+{
+    // immediately reuse the handle for a new request
+    const CURLcode result = request.result.value();
+    long status_code = 0;
+    long connections = 0;
+    curl_easy_getinfo(request.easy, CURLINFO_RESPONSE_CODE, &status_code);
+    curl_easy_getinfo(request.easy, CURLINFO_NUM_CONNECTS, &connections);
+    _stats.connections += static_cast<uint64_t>(connections);
+    const std::string body = std::move(request.body);
+    issue(request);
+
+    if (result != CURLE_OK || status_code != 200)
+    {
+        report_failure(result != CURLE_OK ? curl_easy_strerror(result) : "HTTP status " + std::to_string(status_code));
+        return Snapshot::invalid();
+    }
+
+    auto snapshot = parse_snapshot(body);
+    if (!snapshot.has_value())
     {
-        std::cerr << "Failed to fetch data from " << esp_server_ip << std::endl;
+        report_failure(std::string("malformed snapshot: ") + to_string(snapshot.error()));
         return Snapshot::invalid();
     }
-    return snapshot_from_string(r.text);
+
+    if (failing)
+    {
+        std::cerr << "Fetching data from " << esp_server_ip << " recovered" << std::endl;
+        failing = false;
+    }
+
+    _stats.responses++;
+    auto same_points = [](const Snapshot &lhs, const Snapshot &rhs) {
+        for (size_t i = 0; i < lhs.points.size(); i++)
+        {
+            if (lhs.points[i].x != rhs.points[i].x || lhs.points[i].y != rhs.points[i].y)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    duplicate = previous.has_value() && same_points(previous.value(), snapshot.value());
+    if (duplicate)
+    {
+        _stats.duplicates++;
+    }
+    previous = snapshot.value();
+
+    return snapshot.value();
+}
+
+bool DataAcqHTTP::last_was_duplicate() const
+{
+    return duplicate;
+}
+
+DataAcqHTTP::Stats DataAcqHTTP::stats() const
+{
+    return _stats;
 }
@@ -0,0 +1,187 @@
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "DataAcqMappedPlayback.h"
+#include "Trace.h"
+
+DataAcqMappedPlayback::DataAcqMappedPlayback(const std::string &file_name, std::optional<uint32_t> fps)
+{
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        printf("Failed to open file %s\n", file_name.c_str());
+        printf("%s\n", std::strerror(errno));
+        return;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(Recording::Header))
+    {
+        printf("Failed to read the header of %s\n", file_name.c_str());
+        ::close(fd);
+        return;
+    }
+
+    mapping_size = file_stat.st_size;
+    mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        printf("Failed to map file %s\n", file_name.c_str());
+        printf("%s\n", std::strerror(errno));
+        mapping = nullptr;
+        return;
+    }
+
+    _header = static_cast<const Recording::Header *>(mapping);
+    if (auto error = Recording::validate(*_header, mapping_size); error.has_value())
+    {
+        printf("Invalid recording %s: %s\n", file_name.c_str(), error->c_str());
+        munmap(mapping, mapping_size);
+        mapping = nullptr;
+        return;
+    }
+
+    // the file is read sequentially during playback
+    madvise(mapping, mapping_size, MADV_SEQUENTIAL);
+
+    const auto *base = static_cast<const std::byte *>(mapping) + sizeof(Recording::Header);
+    frames = {reinterpret_cast<const Snapshot *>(base), _header->frame_count};
+    if (_header->flags & Recording::HasTimestamps)
+    {
+        timestamps = {reinterpret_cast<const Recording::Timestamp *>(base + frames.size_bytes()), _header->frame_count};
+    }
+
+    this->fps = fps.value_or(_header->fps);
+    if (timestamps.empty() && this->fps > 0)
+    {
+        pacer = FramePacer(std::chrono::nanoseconds(std::chrono::seconds(1)) / this->fps);
+    }
+}
+
+DataAcqMappedPlayback::~DataAcqMappedPlayback()
+{
+    if (mapping != nullptr)
+    {
+        munmap(mapping, mapping_size);
+    }
+}
+
+Snapshot DataAcqMappedPlayback::get(bool no_sleep)
+{
+    if (!is_open() || frames.empty())
+    {
+        return Snapshot::invalid();
+    }
+
+    rewind_at_end();
+    if (auto deadline = no_sleep ? std::nullopt : schedule(); deadline.has_value())
+    {
+        std::this_thread::sleep_until(deadline.value());
+        pacer.tick(deadline.value());
+    }
+
+    return frames[next_frame++];
+}
+
+Task<Snapshot> DataAcqMappedPlayback::get_async(EventLoop &loop)
+{
+    if (!is_open() || frames.empty())
+    {
+        co_return Snapshot::invalid();
+    }
+
+    rewind_at_end();
+    if (auto deadline = schedule(); deadline.has_value())
+    {
+        co_await loop.sleep_until(deadline.value());
+        pacer.tick(deadline.value());
+    }
+
+    co_return frames[next_frame++];
+}
+
+void DataAcqMappedPlayback::rewind_at_end()
+{
+    if (next_frame >= frames.size())
+    {
+        if (pacer.stats().ticks > 0)
+        {
+            printf("Playback pass: %s\n", pacer.stats().to_string().c_str());
+            pacer.reset_stats();
+        }
+        seek(0);
+    }
+}
+
+std::optional<FramePacer::clock::time_point> DataAcqMappedPlayback::schedule()
+{
+    if (!timestamps.empty())
+    {
+        // reproduce the recorded inter-frame timing
+        auto offset_us = timestamps[next_frame] - timestamps[schedule_origin];
+        return pacer.schedule_offset(std::chrono::microseconds(offset_us));
+    }
+    if (fps > 0)
+    {
+        return pacer.schedule_next();
+    }
+    return std::nullopt;
+}
+
+Snapshot DataAcqMappedPlayback::get()
+{
+    TRACE_SPAN("DataAcqMappedPlayback::get");
+    return get(false);
+}
+
+bool DataAcqMappedPlayback::is_open() const
+{
+    return mapping != nullptr;
+}
+
+const Recording::Header &DataAcqMappedPlayback::header() const
+{
+    return *_header;
+}
+
+size_t DataAcqMappedPlayback::frame_count() const
+{
+    return frames.size();
+}
+
+const Snapshot &DataAcqMappedPlayback::frame(size_t index) const
+{
+    return frames[index];
+}
+
+std::optional<Recording::Timestamp> DataAcqMappedPlayback::timestamp(size_t index) const
+{
+    if (timestamps.empty())
+    {
+        return std::nullopt;
+    }
+    return timestamps[index];
+}
+
+void DataAcqMappedPlayback::seek(size_t index)
+{
+    next_frame = index;
+    schedule_origin = std::min(index, frames.empty() ? 0 : frames.size() - 1);
+    pacer.restart();
+}
+
+size_t DataAcqMappedPlayback::position() const
+{
+    return next_frame;
+}
+
+FramePacer::Stats DataAcqMappedPlayback::pacing_stats() const
+{
+    return pacer.stats();
+}
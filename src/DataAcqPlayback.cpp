@@ -1,11 +1,12 @@
 #include <cerrno>
 #include <cstring>
-#include <thread>
 #include "DataAcqPlayback.h"
+#include "Trace.h"
 
 DataAcqPlayback::DataAcqPlayback(std::string file_name, uint8_t fps) :
     input(file_name),
-    fps(fps)
+    fps(fps),
+    pacer(std::chrono::nanoseconds(std::chrono::seconds(1)) / fps)
 {
     if (!input.is_open())
     {
@@ -24,14 +25,11 @@ DataAcqPlayback::~DataAcqPlayback()
 
 Snapshot DataAcqPlayback::get(bool no_sleep)
 {
-    // to simulate the requested fps, we sleep here
-    // after profiling, the mapping takes around 70 microseconds
-    // so we can sleep for the remaining time
-
+    // to simulate the requested fps, wait for the next frame deadline
+    // deadlines are absolute, so the time the caller spends between calls doesn't add up
     if (!no_sleep)
     {
-        auto sleep_time = std::chrono::milliseconds(1000 / fps) - std::chrono::microseconds(70);
-        std::this_thread::sleep_for(sleep_time);
+        pacer.wait_next();
     }
 
     if (!input.is_open())
@@ -41,6 +39,11 @@ Snapshot DataAcqPlayback::get(bool no_sleep)
 
     if (input.eof())
     {
+        if (pacer.stats().ticks > 0)
+        {
+            printf("Playback pass: %s\n", pacer.stats().to_string().c_str());
+            pacer.reset_stats();
+        }
         input.clear();
         input.seekg(0, std::ios::beg);
     }
@@ -50,11 +53,27 @@ Snapshot DataAcqPlayback::get(bool no_sleep)
         return Snapshot::invalid();
     }
 
-    return snapshot_from_string(line);
+    auto snapshot = parse_snapshot(line);
+    if (!snapshot.has_value())
+    {
+        printf("Malformed snapshot \"%s\": %s\n", line.c_str(), to_string(snapshot.error()));
+        return Snapshot::invalid();
+    }
+    return snapshot.value();
+}
+
+Task<Snapshot> DataAcqPlayback::get_async(EventLoop &loop)
+{
+    // the same deadlines as `get()`, waited for on a timer
+    auto deadline = pacer.schedule_next();
+    co_await loop.sleep_until(deadline);
+    pacer.tick(deadline);
+    co_return get(true);
 }
 
 Snapshot DataAcqPlayback::get()
 {
+    TRACE_SPAN("DataAcqPlayback::get");
     return get(false);
 }
 
@@ -62,3 +81,8 @@ bool DataAcqPlayback::is_open()
 {
     return input.is_open();
 }
+
+FramePacer::Stats DataAcqPlayback::pacing_stats() const
+{
+    return pacer.stats();
+}
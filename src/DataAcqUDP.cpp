@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "DataAcqUDP.h"
+#include "Trace.h"
+
+namespace
+{
+    // consecutive packets behind the window before we assume the sender restarted its sequence
+    constexpr uint32_t resync_threshold = 8;
+}
+
+DataAcqUDP::DataAcqUDP(uint16_t port, std::chrono::milliseconds timeout)
+    : timeout(timeout)
+{
+    socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socket_fd < 0)
+    {
+        printf("Failed to create a UDP socket\n");
+        printf("%s\n", std::strerror(errno));
+        return;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(socket_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        printf("Failed to bind UDP port %u\n", port);
+        printf("%s\n", std::strerror(errno));
+        ::close(socket_fd);
+        socket_fd = -1;
+        return;
+    }
+
+    // a bounded wait lets the acquisition thread notice a stop request while the stream is silent
+    timeval receive_timeout{};
+    receive_timeout.tv_sec = timeout.count() / 1000;
+    receive_timeout.tv_usec = (timeout.count() % 1000) * 1000;
+    setsockopt(socket_fd, SOL_SOCKET, SO_RCVTIMEO, &receive_timeout, sizeof(receive_timeout));
+}
+
+DataAcqUDP::~DataAcqUDP()
+{
+    if (socket_fd >= 0)
+    {
+        ::close(socket_fd);
+    }
+}
+
+bool DataAcqUDP::is_open() const
+{
+    return socket_fd >= 0;
+}
+
+Snapshot DataAcqUDP::get()
+{
+    TRACE_SPAN("DataAcqUDP::get");
+
+    if (!is_open())
+    {
+        return Snapshot::invalid();
+    }
+
+    auto deadline = clock::now() + timeout;
+    bool fresh = false;
+    Snapshot newest = Snapshot::invalid();
+    while (!fresh)
+    {
+        // block for the first datagram, then drain whatever else is queued and keep the newest
+        fresh = receive(newest, 0);
+        if (!fresh && clock::now() >= deadline)
+        {
+            _stats.timeouts++;
+            break;
+        }
+    }
+
+    if (fresh)
+    {
+        delivered();
+    }
+    return newest;
+}
+
+Task<Snapshot> DataAcqUDP::get_async(EventLoop &loop)
+{
+    Snapshot newest = Snapshot::invalid();
+    if (!is_open())
+    {
+        co_return newest;
+    }
+
+    // drained before waiting, a datagram queued since the last call doesn't need a wakeup
+    while (!receive(newest, MSG_DONTWAIT))
+    {
+        co_await loop.readable(socket_fd);
+    }
+    delivered();
+    co_return newest;
+}
+
+bool DataAcqUDP::receive(Snapshot &newest, int flags)
+{
+    bool fresh = false;
+    while (true)
+    {
+        // with MSG_TRUNC the size is the datagram's real length, a longer datagram doesn't pass as a packet
+        Datagram::Packet packet;
+        auto size = recv(socket_fd, &packet, sizeof(packet), flags | MSG_TRUNC);
+        if (size < 0)
+        {
+            break;
+        }
+        flags = MSG_DONTWAIT;
+        auto receive_time = clock::now();
+
+        if (static_cast<size_t>(size) != sizeof(packet) || packet.magic != Datagram::magic)
+        {
+            _stats.malformed++;
+            continue;
+        }
+        if (accept(packet, receive_time))
+        {
+            if (fresh)
+            {
+                _stats.superseded++;
+            }
+            newest = packet.snapshot;
+            fresh = true;
+        }
+    }
+    return fresh;
+}
+
+void DataAcqUDP::delivered()
+{
+    _stats.delivered++;
+}
+
+bool DataAcqUDP::accept(const Datagram::Packet &packet, clock::time_point receive_time)
+{
+    if (!synced)
+    {
+        synced = true;
+        highest_sequence = packet.sequence;
+        window = 1;
+        _stats.received++;
+        record_latency(packet.device_time_us, receive_time);
+        return true;
+    }
+
+    auto distance = Datagram::sequence_distance(highest_sequence, packet.sequence);
+    if (distance > 0)
+    {
+        // newer than anything so far, the skipped sequence numbers are lost unless they show up late
+        out_of_window = 0;
+        window = distance >= 64 ? 0 : window << distance;
+        window |= 1;
+        highest_sequence = packet.sequence;
+        _stats.lost += distance - 1;
+        _stats.received++;
+        record_latency(packet.device_time_us, receive_time);
+        return true;
+    }
+
+    auto age = static_cast<uint32_t>(-static_cast<int64_t>(distance));
+    if (age >= 64)
+    {
+        if (++out_of_window >= resync_threshold)
+        {
+            // the sender restarted, follow the new sequence and its new clock
+            _stats.resyncs++;
+            synced = false;
+            out_of_window = 0;
+            offset_us.clear();
+            return accept(packet, receive_time);
+        }
+        _stats.reordered++;
+        return false;
+    }
+
+    out_of_window = 0;
+    uint64_t bit = uint64_t{1} << age;
+    if (window & bit)
+    {
+        _stats.duplicate++;
+        return false;
+    }
+
+    // it was counted as lost when a newer packet skipped it
+    window |= bit;
+    _stats.lost--;
+    _stats.reordered++;
+    _stats.received++;
+    return false;
+}
+
+void DataAcqUDP::record_latency(uint64_t device_time_us, clock::time_point receive_time)
+{
+    auto receive_us = std::chrono::duration_cast<std::chrono::microseconds>(receive_time.time_since_epoch()).count();
+    auto offset = receive_us - static_cast<int64_t>(device_time_us);
+    if (offset_us.count() == 0)
+    {
+        first_offset_us = offset;
+        min_offset_us = 0;
+    }
+
+    auto relative = static_cast<float>(offset - first_offset_us);
+    min_offset_us = std::min(min_offset_us, relative);
+    offset_us.add(relative);
+}
+
+DataAcqUDP::Stats DataAcqUDP::stats() const
+{
+    // the fastest packet so far had the least latency, the others are measured against it
+    Stats result = _stats;
+    auto offsets = offset_us.percentiles();
+    if (offset_us.count() > 0)
+    {
+        result.latency_p50_us = offsets.p50 - min_offset_us;
+        result.latency_p99_us = offsets.p99 - min_offset_us;
+        result.latency_max_us = offsets.max - min_offset_us;
+    }
+    return result;
+}
+
+std::string DataAcqUDP::Stats::to_string() const
+{
+    auto expected = received + lost;
+    double loss = expected > 0 ? 100.0 * lost / expected : 0;
+    return std::format("{} received, {} delivered, {} superseded, {} lost ({:.2f}%), {} reordered, {} duplicate, {} malformed, "
+                       "{} timeouts, {} resyncs, latency p50 {:.0f} us, p99 {:.0f} us, max {:.0f} us",
+                       received, delivered, superseded, lost, loss, reordered, duplicate, malformed,
+                       timeouts, resyncs, latency_p50_us, latency_p99_us, latency_max_us);
+}
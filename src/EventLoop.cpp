@@ -0,0 +1,284 @@
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <format>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include "EventLoop.h"
+#include "Trace.h"
+
+namespace
+{
+    // events handled per `epoll_wait`, more stay queued for the next one
+    constexpr int max_events = 16;
+
+    std::chrono::nanoseconds thread_cpu_time()
+    {
+        timespec time{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+        return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+    }
+
+    bool add_to_epoll(int epoll_fd, int fd, uint32_t events)
+    {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+}
+
+void EventLoop::Signal::notify()
+{
+    if (!waiter)
+    {
+        pending = true;
+        return;
+    }
+    generation++;
+    notified = true;
+    loop.signals++;
+    loop.post(std::exchange(waiter, nullptr));
+}
+
+EventLoop::EventLoop()
+{
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || timer_fd < 0 || stop_fd < 0 || !add_to_epoll(epoll_fd, timer_fd, EPOLLIN) ||
+        !add_to_epoll(epoll_fd, stop_fd, EPOLLIN))
+    {
+        printf("Failed to create the event loop\n");
+        printf("%s\n", std::strerror(errno));
+        for (int *fd : {&epoll_fd, &timer_fd, &stop_fd})
+        {
+            if (*fd >= 0)
+            {
+                ::close(*fd);
+                *fd = -1;
+            }
+        }
+    }
+}
+
+EventLoop::~EventLoop()
+{
+    // the suspended tasks go first, their awaiters may refer to the loop
+    tasks.clear();
+    for (int fd : {epoll_fd, timer_fd, stop_fd})
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+    }
+}
+
+bool EventLoop::is_open() const
+{
+    return epoll_fd >= 0;
+}
+
+void EventLoop::spawn(Task<void> task)
+{
+    tasks.push_back(std::move(task));
+    post(tasks.back().handle);
+}
+
+void EventLoop::stop()
+{
+    uint64_t one = 1;
+    if (stop_fd >= 0 && ::write(stop_fd, &one, sizeof(one)) != sizeof(one))
+    {
+        printf("Failed to stop the event loop: %s\n", std::strerror(errno));
+    }
+}
+
+void EventLoop::post(std::coroutine_handle<> handle)
+{
+    ready.push_back(handle);
+}
+
+void EventLoop::add_timer(clock::time_point deadline, std::coroutine_handle<> handle, Signal *signal)
+{
+    timers.push(Timer{deadline, handle, signal, signal != nullptr ? signal->generation : 0});
+}
+
+void EventLoop::wait_readable(int fd, std::coroutine_handle<> handle)
+{
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.fd = fd;
+    auto [reader, added] = readers.try_emplace(fd, handle);
+    reader->second = handle;
+    if (epoll_ctl(epoll_fd, added ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event) != 0)
+    {
+        // the task would never be resumed, e.g. for a closed descriptor
+        printf("Failed to wait for descriptor %d: %s\n", fd, std::strerror(errno));
+        reader->second = nullptr;
+        post(handle);
+    }
+}
+
+void EventLoop::arm_timerfd()
+{
+    // notified signals leave their timer behind, those don't need a wakeup
+    while (!timers.empty() && timers.top().signal != nullptr && timers.top().signal->generation != timers.top().generation)
+    {
+        timers.pop();
+    }
+
+    std::optional<clock::time_point> deadline;
+    if (!timers.empty())
+    {
+        deadline = timers.top().deadline;
+    }
+    if (deadline == armed_deadline)
+    {
+        return;
+    }
+
+    // `steady_clock` is `CLOCK_MONOTONIC`, an absolute deadline in the past fires at once, all zero disarms
+    itimerspec spec{};
+    if (deadline.has_value())
+    {
+        const auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline->time_since_epoch());
+        spec.it_value.tv_sec = std::max<int64_t>(since_epoch.count() / 1'000'000'000, 0);
+        spec.it_value.tv_nsec = std::max<int64_t>(since_epoch.count() % 1'000'000'000, 1);
+    }
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+    armed_deadline = deadline;
+}
+
+void EventLoop::fire_timers(clock::time_point now)
+{
+    // only the timers due now, a task that sleeps until a passed deadline again runs on the next iteration
+    while (!timers.empty() && timers.top().deadline <= now)
+    {
+        const Timer timer = timers.top();
+        timers.pop();
+        if (timer.signal != nullptr)
+        {
+            if (timer.signal->generation != timer.generation)
+            {
+                continue;
+            }
+            timer.signal->generation++;
+            timer.signal->waiter = nullptr;
+            timer.signal->notified = false;
+        }
+        due.push_back(timer);
+    }
+
+    for (const auto &timer : due)
+    {
+        timer_events++;
+        timer_lateness.record(clock::now() - timer.deadline);
+        timer.handle.resume();
+    }
+    due.clear();
+}
+
+void EventLoop::resume_ready()
+{
+    std::swap(ready, running);
+    for (auto handle : running)
+    {
+        handle.resume();
+    }
+    running.clear();
+}
+
+void EventLoop::run()
+{
+    if (!is_open())
+    {
+        return;
+    }
+    Trace::set_thread_name("event loop");
+    const auto start = clock::now();
+    const auto cpu_start = thread_cpu_time();
+
+    std::array<epoll_event, max_events> events;
+    stopping = false;
+    while (!stopping)
+    {
+        resume_ready();
+        std::erase_if(tasks, [](const Task<void> &task) { return task.done(); });
+
+        arm_timerfd();
+        const auto wait_start = clock::now();
+        const int count = epoll_wait(epoll_fd, events.data(), max_events, ready.empty() ? -1 : 0);
+        const auto wakeup = clock::now();
+        idle_time += wakeup - wait_start;
+        wakeups++;
+        if (count < 0 && errno != EINTR)
+        {
+            printf("Event loop wait failed: %s\n", std::strerror(errno));
+            break;
+        }
+
+        TRACE_SPAN("EventLoop::dispatch");
+        for (int i = 0; i < count; i++)
+        {
+            const int fd = events[i].data.fd;
+            if (fd == stop_fd || fd == timer_fd)
+            {
+                // drain the counter, the timers are checked below either way
+                uint64_t value = 0;
+                while (::read(fd, &value, sizeof(value)) > 0) {}
+                if (fd == stop_fd)
+                {
+                    stopping = true;
+                }
+                else
+                {
+                    armed_deadline.reset();
+                }
+                continue;
+            }
+
+            auto reader = readers.find(fd);
+            if (reader == readers.end() || !reader->second)
+            {
+                continue;
+            }
+            io_events++;
+            io_dispatch.record(clock::now() - wakeup);
+            std::exchange(reader->second, nullptr).resume();
+        }
+        fire_timers(clock::now());
+    }
+
+    run_time += clock::now() - start;
+    cpu_time += thread_cpu_time() - cpu_start;
+}
+
+EventLoop::Stats EventLoop::stats() const
+{
+    Stats result;
+    result.wakeups = wakeups;
+    result.timer_events = timer_events;
+    result.io_events = io_events;
+    result.signals = signals;
+    result.timer_lateness = timer_lateness.counts();
+    result.io_dispatch = io_dispatch.counts();
+    result.run_seconds = std::chrono::duration<double>(run_time).count();
+    result.idle_seconds = std::chrono::duration<double>(idle_time).count();
+    result.cpu_seconds = std::chrono::duration<double>(cpu_time).count();
+    return result;
+}
+
+std::string EventLoop::Stats::to_string() const
+{
+    return std::format("wakeups: {}, timers: {}, io: {}, signals: {}, timer lateness p50: {:.3f} ms, p99: {:.3f} ms, "
+                       "io dispatch p50: {:.3f} ms, p99: {:.3f} ms, idle: {:.1f}%, cpu: {:.2f}%",
+        wakeups, timer_events, io_events, signals, timer_lateness.percentile_ms(0.5), timer_lateness.percentile_ms(0.99),
+        io_dispatch.percentile_ms(0.5), io_dispatch.percentile_ms(0.99),
+        run_seconds > 0 ? 100 * idle_seconds / run_seconds : 0, run_seconds > 0 ? 100 * cpu_seconds / run_seconds : 0);
+}
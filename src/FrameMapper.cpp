@@ -0,0 +1,97 @@
+#include <cstdio>
+#include "FrameMapper.h"
+#include "LinAlgPointMapping.h"
+#include "Trace.h"
+
+FrameMapper::FrameMapper(const ScreenCorners &screen_corners, bool debug_mode, float reuse_tolerance,
+                         std::unique_ptr<ICursorFilter> cursor_filter, bool track_partial_visibility, LiveStats *live_stats)
+    : screen_corners(screen_corners),
+      debug_mode(debug_mode),
+      cursor_filter(std::move(cursor_filter)),
+      live_stats(live_stats)
+{
+    if (track_partial_visibility)
+    {
+        tracker.emplace();
+    }
+
+    // opt-in reuse of the perspective transform across near-identical frames
+    if (reuse_tolerance > 0)
+    {
+        cached_mapper.emplace(reuse_tolerance);
+    }
+}
+
+void FrameMapper::map(const Snapshot &snapshot, std::chrono::steady_clock::time_point capture_time, MappedFrame &mapped)
+{
+    TRACE_SPAN("FrameMapper::map");
+    const auto start = std::chrono::steady_clock::now();
+    map_frame(snapshot, capture_time, mapped);
+    if (live_stats != nullptr)
+    {
+        live_stats->mapping.record(std::chrono::steady_clock::now() - start);
+        // only frames without a result count, a partial frame the tracker recovered is mapped.
+        // the mapper's own error tells them apart where it reports one
+        if (!mapped.cursor.has_value() && !mapped.debug_borders.has_value())
+        {
+            const bool invalid = mapped.error.has_value() ? mapped.error == MappingError::InvalidSnapshot : !snapshot.is_valid();
+            if (invalid)
+            {
+                live_stats->invalid_frames.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                live_stats->failed_frames.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+void FrameMapper::map_frame(const Snapshot &snapshot, std::chrono::steady_clock::time_point capture_time, MappedFrame &mapped)
+{
+    mapped.sequence = ++mapped_frames;
+    mapped.snapshot = snapshot;
+    mapped.capture_time = capture_time;
+    mapped.cursor.reset();
+    mapped.confidence = 0;
+    mapped.debug_borders.reset();
+    mapped.error.reset();
+
+    if (debug_mode)
+    {
+        auto opt_borders = map_snapshot_to_borders(snapshot);
+        if (!opt_borders.has_value())
+        {
+            printf("Error: %s\n", to_string(opt_borders.error()));
+            mapped.error = opt_borders.error();
+            return;
+        }
+        mapped.debug_borders = opt_borders.value();
+        return;
+    }
+
+    if (tracker.has_value())
+    {
+        auto tracked = tracker->map_snapshot_to_cursor(snapshot, screen_corners);
+        if (tracked.has_value())
+        {
+            mapped.cursor = tracked->cursor;
+            mapped.confidence = tracked->confidence;
+        }
+        else
+        {
+            mapped.error = tracked.error();
+        }
+    }
+    else
+    {
+        mapped.cursor = cached_mapper.has_value()
+            ? cached_mapper->map_snapshot_to_cursor(snapshot, screen_corners)
+            : LinAlgPointMapping::map_snapshot_to_cursor(snapshot, screen_corners);
+        mapped.confidence = mapped.cursor.has_value() ? 1 : 0;
+    }
+    if (mapped.cursor.has_value() && cursor_filter)
+    {
+        mapped.cursor = cursor_filter->filter(mapped.cursor.value(), capture_time.time_since_epoch());
+    }
+}
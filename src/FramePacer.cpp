@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <format>
+#include <thread>
+#include "FramePacer.h"
+
+FramePacer::FramePacer(std::chrono::nanoseconds period)
+    : period(period)
+{
+}
+
+void FramePacer::restart()
+{
+    start = clock::now();
+    next_deadline = start + period;
+    started = true;
+}
+
+FramePacer::clock::time_point FramePacer::wait_next()
+{
+    auto deadline = schedule_next();
+    wait_until(deadline);
+    return deadline;
+}
+
+FramePacer::clock::time_point FramePacer::wait_until_offset(std::chrono::nanoseconds offset)
+{
+    auto deadline = schedule_offset(offset);
+    wait_until(deadline);
+    return deadline;
+}
+
+FramePacer::clock::time_point FramePacer::schedule_next()
+{
+    if (!started)
+    {
+        restart();
+    }
+
+    auto now = clock::now();
+    if (period == std::chrono::nanoseconds::zero())
+    {
+        // no periodic schedule, don't wait
+        return now;
+    }
+
+    if (now > next_deadline + period)
+    {
+        // more than a period late, skip the missed deadlines instead of bursting
+        auto missed = (now - next_deadline) / period;
+        next_deadline += missed * period;
+        realigned++;
+    }
+    auto deadline = next_deadline;
+    next_deadline += period;
+    return deadline;
+}
+
+FramePacer::clock::time_point FramePacer::schedule_offset(std::chrono::nanoseconds offset)
+{
+    if (!started)
+    {
+        restart();
+    }
+    return start + offset;
+}
+
+void FramePacer::wait_until(clock::time_point deadline)
+{
+    std::this_thread::sleep_until(deadline);
+    tick(deadline);
+}
+
+void FramePacer::tick(clock::time_point deadline)
+{
+    auto now = clock::now();
+    float late_us = std::chrono::duration<float, std::micro>(std::max(now - deadline, clock::duration::zero())).count();
+    lateness_us.add(late_us);
+
+    if (ticks == 0)
+    {
+        first_tick = now;
+    }
+    last_tick = now;
+    ticks++;
+}
+
+void FramePacer::reset_stats()
+{
+    ticks = 0;
+    realigned = 0;
+    lateness_us.clear();
+}
+
+FramePacer::Stats FramePacer::stats() const
+{
+    Stats result;
+    result.ticks = ticks;
+    result.realigned = realigned;
+    if (ticks == 0)
+    {
+        return result;
+    }
+
+    if (ticks > 1)
+    {
+        result.achieved_rate = (ticks - 1) / std::chrono::duration<double>(last_tick - first_tick).count();
+    }
+
+    auto jitter = lateness_us.percentiles();
+    result.jitter_p50_us = jitter.p50;
+    result.jitter_p99_us = jitter.p99;
+    result.jitter_max_us = jitter.max;
+    return result;
+}
+
+std::string FramePacer::Stats::to_string() const
+{
+    return std::format("ticks: {}, achieved rate: {:.2f} Hz, jitter p50: {:.1f} us, p99: {:.1f} us, max: {:.1f} us, realigned: {}",
+        ticks, achieved_rate, jitter_p50_us, jitter_p99_us, jitter_max_us, realigned);
+}
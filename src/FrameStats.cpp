@@ -0,0 +1,51 @@
+#include <format>
+#include "FrameStats.h"
+
+void FrameStats::skipped()
+{
+    skipped_frames++;
+}
+
+void FrameStats::overlay_refreshed()
+{
+    overlay_refreshes++;
+}
+
+void FrameStats::presented(clock::time_point capture_time)
+{
+    auto now = clock::now();
+    if (presented_frames == 0)
+    {
+        first_present = now;
+    }
+    else
+    {
+        frame_time_ms.add(std::chrono::duration<float, std::milli>(now - last_present).count());
+    }
+    latency_ms.add(std::chrono::duration<float, std::milli>(now - capture_time).count());
+    last_present = now;
+    presented_frames++;
+}
+
+FrameStats::Summary FrameStats::summary() const
+{
+    Summary result;
+    result.presented = presented_frames;
+    result.skipped = skipped_frames;
+    result.overlay_refreshed = overlay_refreshes;
+    if (presented_frames > 1)
+    {
+        result.present_rate = (presented_frames - 1) / std::chrono::duration<double>(last_present - first_present).count();
+    }
+    result.frame_time_ms = frame_time_ms.percentiles();
+    result.latency_ms = latency_ms.percentiles();
+    return result;
+}
+
+std::string FrameStats::Summary::to_string() const
+{
+    return std::format("presented: {}, skipped: {}, overlay refreshes: {}, rate: {:.2f} Hz, frame time p50: {:.2f} ms, p99: {:.2f} ms, max: {:.2f} ms, "
+                       "latency p50: {:.2f} ms, p99: {:.2f} ms, max: {:.2f} ms",
+        presented, skipped, overlay_refreshed, present_rate, frame_time_ms.p50, frame_time_ms.p99, frame_time_ms.max,
+        latency_ms.p50, latency_ms.p99, latency_ms.max);
+}
@@ -0,0 +1,37 @@
+#include <algorithm>
+#include "GunSet.h"
+
+GunSet::Gun::Gun(IDataAcq *source, const Params &params)
+    : mapping(source, params.screen_corners, params.debug_mode, params.reuse_tolerance,
+              make_cursor_filter(params.filter), params.track_partial_visibility, &stats)
+{
+}
+
+GunSet::GunSet(std::span<IDataAcq *const> sources, const Params &params)
+{
+    const size_t count = std::min(sources.size(), max_guns);
+    guns.reserve(count);
+    for (size_t gun = 0; gun < count; gun++)
+    {
+        guns.push_back(std::make_unique<Gun>(sources[gun], params));
+    }
+}
+
+bool GunSet::update()
+{
+    bool any = false;
+    for (auto &gun : guns)
+    {
+        gun->fresh = gun->mapping.update();
+        any = any || gun->fresh;
+    }
+    return any;
+}
+
+void GunSet::stop()
+{
+    for (auto &gun : guns)
+    {
+        gun->mapping.stop();
+    }
+}
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include "LatencyHistogram.h"
+
+size_t LatencyHistogram::bucket_index(uint64_t value_us)
+{
+    value_us = std::min(value_us, max_trackable_us);
+    if (value_us < 2 * sub_buckets)
+    {
+        return value_us;
+    }
+    // the top `sub_bucket_bits + 1` bits select the bucket within the value's power of 2
+    const uint32_t magnitude = std::bit_width(value_us) - 1;
+    const uint32_t shift = magnitude - sub_bucket_bits;
+    return (shift + 1) * sub_buckets + ((value_us >> shift) - sub_buckets);
+}
+
+uint64_t LatencyHistogram::bucket_upper_us(size_t bucket_index)
+{
+    if (bucket_index < 2 * sub_buckets)
+    {
+        return bucket_index;
+    }
+    const uint32_t shift = bucket_index / sub_buckets - 1;
+    const uint64_t top = bucket_index % sub_buckets + sub_buckets;
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds duration)
+{
+    record_us(static_cast<uint64_t>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), 0)));
+}
+
+void LatencyHistogram::record_us(uint64_t value_us)
+{
+    buckets[bucket_index(value_us)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = _max_us.load(std::memory_order_relaxed);
+    while (value_us > max && !_max_us.compare_exchange_weak(max, value_us, std::memory_order_relaxed))
+    {
+    }
+}
+
+LatencyHistogram::Counts LatencyHistogram::counts() const
+{
+    Counts result;
+    for (size_t i = 0; i < bucket_count; i++)
+    {
+        result.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+        result.count += result.buckets[i];
+    }
+    result.max_us = _max_us.load(std::memory_order_relaxed);
+    return result;
+}
+
+LatencyHistogram::Counts LatencyHistogram::Counts::since(const Counts &earlier) const
+{
+    Counts result;
+    for (size_t i = 0; i < bucket_count; i++)
+    {
+        result.buckets[i] = buckets[i] - std::min(buckets[i], earlier.buckets[i]);
+        result.count += result.buckets[i];
+        if (result.buckets[i] > 0)
+        {
+            // the bucket bound, the exact max of the values in between isn't known
+            result.max_us = std::min(bucket_upper_us(i), max_us);
+        }
+    }
+    return result;
+}
+
+LatencyHistogram::Counts &LatencyHistogram::Counts::operator+=(const Counts &other)
+{
+    for (size_t i = 0; i < bucket_count; i++)
+    {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    max_us = std::max(max_us, other.max_us);
+    return *this;
+}
+
+double LatencyHistogram::Counts::percentile_ms(double p) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * count)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucket_count; i++)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+        {
+            return std::min(bucket_upper_us(i), max_us) / 1000.0;
+        }
+    }
+    return max_us / 1000.0;
+}
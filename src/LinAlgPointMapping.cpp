@@ -1,91 +1,99 @@
 #include <algorithm>
+#include <bit>
 #include <cmath>
+#include <cstdio>
 #include <limits>
 #include <ranges>
+#include <type_traits>
 
 #include "LinAlgPointMapping.h"
+#include "Trace.h"
 
 namespace LinAlgPointMapping {
-    template <size_t N> using float_mat = std::array<std::array<float, N>, N>;
-    template <size_t N> using float_arr = std::array<float, N>;
-
     using float3_arr = float_arr<3>;
-    using float3_mat = float_mat<3>;
     using float8_arr = float_arr<8>;
     using float8_mat = float_mat<8>;
 
-    // destructible call, doesn't copy `lhs` or `rhs`
-    template<size_t N>
-    static std::optional<float_arr<N>> gaussianEliminationInPlace(float_mat<N> &lhs, float_arr<N> &rhs) {
-        float_arr<N> result{};
-
-        for (size_t it = 0; it < N; it++) {
-            // select row with largest first element for numerical stability
-            auto pivot_row = it;
-            for (size_t row_it = it + 1; row_it < N; row_it++) {
-                if (std::fabs(lhs[row_it][it]) > std::fabs(lhs[pivot_row][it])) {
-                    pivot_row = row_it;
-                }
-            }
-            if (std::fabs(lhs[pivot_row][it]) < std::numeric_limits<float>::epsilon()) {
-                return std::nullopt;
-            }
+    // checks if `a`, `b` and `c` are on the same line, relative to the magnitude of the cross product terms
+    template<typename T>
+    static inline bool collinear(T ax, T ay, T bx, T by, T cx, T cy) {
+        using std::abs;
+        const T lhs = (bx - ax) * (cy - ay);
+        const T rhs = (by - ay) * (cx - ax);
+        return abs(lhs - rhs) <= std::numeric_limits<T>::epsilon() * (abs(lhs) + abs(rhs));
+    }
 
-            // swap pivot row to the top
-            if (it != pivot_row) {
-                std::swap(lhs[it], lhs[pivot_row]);
-                std::swap(rhs[it], rhs[pivot_row]);
-            }
+    // a quad is degenerate (has no homography) if any 3 of its corners are collinear
+    template<typename T>
+    static inline bool degenerate_quad(T x0, T y0, T x1, T y1, T x2, T y2, T x3, T y3) {
+        return collinear(x0, y0, x1, y1, x2, y2) | collinear(x1, y1, x2, y2, x3, y3) |
+               collinear(x2, y2, x3, y3, x0, y0) | collinear(x3, y3, x0, y0, x1, y1);
+    }
 
-            // normalize the pivot row (which is now at the top)
-            float norm_factor = lhs[it][it];
-            std::ranges::for_each(lhs[it], [norm_factor](float &f) { f /= norm_factor; });
-            rhs[it] /= norm_factor;
-
-            // eliminate the current column in all rows below
-            for (size_t row_it = it + 1; row_it < N; row_it++) {
-                float elim_factor = lhs[row_it][it];
-                for (size_t col_it = it; col_it < N; col_it++) {
-                    lhs[row_it][col_it] -= elim_factor * lhs[it][col_it];
-                }
-                rhs[row_it] -= elim_factor * rhs[it];
-            }
-        }
+    template<typename T>
+    static bool degenerate_quad(const BasicScreenCorners<T> &quad) {
+        return degenerate_quad(quad.top_left.x, quad.top_left.y, quad.top_right.x, quad.top_right.y,
+                               quad.bot_right.x, quad.bot_right.y, quad.bot_left.x, quad.bot_left.y);
+    }
 
-        // if we got here, we now have an upper triangular matrix
-        // we can use back substitution to find the solution
-        for (size_t it = 0; it < N; it++) {
-            auto row_it = N - 1 - it;
-            result[row_it] = rhs[row_it];
-            for (size_t col_it = row_it + 1; col_it < N; col_it++) {
-                result[row_it] -= lhs[row_it][col_it] * result[col_it];
-            }
-        }
+    // closed form homography from the unit square to a non degenerate quad:
+    // (0,0), (1,0), (1,1), (0,1) map to top left, top right, bot right, bot left
+    template<typename T>
+    static scalar_mat<T, 3> square_to_quad(const BasicScreenCorners<T> &quad) {
+        const BasicPoint<T> &p0 = quad.top_left;
+        const BasicPoint<T> &p1 = quad.top_right;
+        const BasicPoint<T> &p2 = quad.bot_right;
+        const BasicPoint<T> &p3 = quad.bot_left;
 
-        return result;
+        const T sx = p0.x - p1.x + p2.x - p3.x;
+        const T sy = p0.y - p1.y + p2.y - p3.y;
+        const T dx1 = p1.x - p2.x, dx2 = p3.x - p2.x;
+        const T dy1 = p1.y - p2.y, dy2 = p3.y - p2.y;
+        const T den = dx1 * dy2 - dx2 * dy1;
+        const T g = (sx * dy2 - dx2 * sy) / den;
+        const T h = (dx1 * sy - sx * dy1) / den;
+        return scalar_mat<T, 3>{{
+            p1.x - p0.x + g * p1.x, p3.x - p0.x + h * p3.x, p0.x,
+            p1.y - p0.y + g * p1.y, p3.y - p0.y + h * p3.y, p0.y,
+            g, h, T(1)}};
     }
 
-    template<size_t N>
-    // basic CPU based matrix-vector multiplication
-    float_arr<N> operator*(const float_mat<N> &lhs, const float_arr<N> &rhs) {
-        float_arr<N> result{};
-        for (size_t row = 0; row < N; row++) {
-            result[row] = 0;
-            for (size_t col = 0; col < N; col++) {
-                result[row] += lhs[row][col] * rhs[col];
-            }
+    // the adjugate is the inverse scaled by the determinant, which is enough for homogeneous coordinates
+    template<typename T>
+    static scalar_mat<T, 3> adjugate(const scalar_mat<T, 3> &m) {
+        const auto &[a, b, c, d, e, f, g, h, i] = m.elements;
+        return scalar_mat<T, 3>{{
+            e * i - f * h, c * h - b * i, b * f - c * e,
+            f * g - d * i, a * i - c * g, c * d - a * f,
+            d * h - e * g, b * g - a * h, a * e - b * d}};
+    }
+
+    // composes `dst <- unit square <- src` instead of solving a linear system
+    static std::optional<float3_mat> getPerspectiveTransformClosedForm(const ScreenCorners &src, const ScreenCorners &dst) {
+        if (degenerate_quad(src) || degenerate_quad(dst))
+        {
+            return std::nullopt;
+        }
+
+        const auto transform = square_to_quad(dst) * adjugate(square_to_quad(src));
+
+        // normalize to the same form as the linear system solution (bottom right element is 1)
+        const float norm_factor = transform[2][2];
+        if (std::fabs(norm_factor) < std::numeric_limits<float>::epsilon())
+        {
+            return std::nullopt;
         }
-        return result;
+        return transform / norm_factor;
     }
 
-    std::optional<float3_mat> getPerspectiveTransform(const ScreenCorners &src, const ScreenCorners &dst) {
-        float8_mat lhs{};
+    static std::optional<float3_mat> getPerspectiveTransformGaussian(const ScreenCorners &src, const ScreenCorners &dst) {
+        float8_mat lhs;
         float8_arr rhs{};
 
         auto fill = [&lhs, &rhs](size_t i, const PointF &src, const PointF &dst) {
-            lhs[2 * i] = {src.x, src.y, 1, 0, 0, 0, -1.0f * src.x * dst.x, -1.0f * src.y * dst.x};
+            lhs.set_row(2 * i, src.x, src.y, 1, 0, 0, 0, -1.0f * src.x * dst.x, -1.0f * src.y * dst.x);
             rhs[2 * i] = dst.x;
-            lhs[2 * i + 1] = {0, 0, 0, src.x, src.y, 1, -1.0f * src.x * dst.y, -1.0f * src.y * dst.y};
+            lhs.set_row(2 * i + 1, 0, 0, 0, src.x, src.y, 1, -1.0f * src.x * dst.y, -1.0f * src.y * dst.y);
             rhs[2 * i + 1] = dst.y;
         };
 
@@ -94,64 +102,362 @@ namespace LinAlgPointMapping {
         fill(2, src.bot_left, dst.bot_left);
         fill(3, src.bot_right, dst.bot_right);
 
-        auto opt_result = gaussianEliminationInPlace(lhs, rhs);
-        if (!opt_result.has_value())
+        auto lu = LinAlg::LU<float, 8>::factorize(lhs);
+        if (!lu.has_value())
         {
             return std::nullopt;
         }
 
         // convert to a 3x3 matrix and return the result
-        const auto &r = opt_result.value();
-        return float3_mat{
-            float3_arr{r[0], r[1], r[2]}, 
-            float3_arr{r[3], r[4], r[5]}, 
-            float3_arr{r[6], r[7], 1.0f}};
+        const auto r = lu->solve(rhs);
+        return float3_mat{{
+            r[0], r[1], r[2],
+            r[3], r[4], r[5],
+            r[6], r[7], 1.0f}};
     }
 
-    std::optional<PointF> map_snapshot_to_cursor(const Snapshot &src, const ScreenCorners &dst_corners)
+    std::optional<float3_mat> getPerspectiveTransform(const ScreenCorners &src, const ScreenCorners &dst, PerspectiveSolver solver) {
+        TRACE_SPAN("getPerspectiveTransform");
+        switch (solver)
+        {
+        case PerspectiveSolver::GaussianElimination:
+            return getPerspectiveTransformGaussian(src, dst);
+        case PerspectiveSolver::ClosedForm:
+            return getPerspectiveTransformClosedForm(src, dst);
+        }
+        return std::nullopt;
+    }
+
+    std::optional<PointF> map_camera_center(const float3_mat &transform)
+    {
+        float3_arr ir_centers_homogenous{ir_camera_centers[0], ir_camera_centers[1], 1.0f};
+
+        const auto mapped = transform * ir_centers_homogenous;
+        if (std::fabs(mapped[2]) < std::numeric_limits<float>::epsilon())
+        {
+            return std::nullopt;
+        }
+
+        return PointF{mapped[0]/mapped[2], mapped[1]/mapped[2]};
+    }
+
+    // fixed point types compute in coordinates scaled to about [-1, 1], the products of camera or screen coordinates
+    // in the homographies would overflow them otherwise. float and double skip the (exact, power of 2) scaling
+    template<typename T>
+    static constexpr bool scale_to_unit = !std::is_floating_point_v<T>;
+
+    template<typename T>
+    static BasicScreenCorners<T> scaled(const BasicScreenCorners<T> &quad, T factor) {
+        auto scale = [factor](const BasicPoint<T> &point) { return BasicPoint<T>{point.x * factor, point.y * factor}; };
+        return BasicScreenCorners<T>(scale(quad.top_left), scale(quad.top_right), scale(quad.bot_left), scale(quad.bot_right));
+    }
+
+    // the smallest power of 2 that is at least as large as every coordinate of `quad`
+    template<typename T>
+    static T unit_scale(const BasicScreenCorners<T> &quad) {
+        using std::abs;
+        T scale(1);
+        for (const auto &corner : {quad.top_left, quad.top_right, quad.bot_left, quad.bot_right}) {
+            while ((abs(corner.x) > scale || abs(corner.y) > scale) && scale < std::numeric_limits<T>::max() / T(2)) {
+                scale = scale + scale;
+            }
+        }
+        return scale;
+    }
+
+    template<typename T>
+    std::optional<BasicPoint<T>> map_snapshot_to_cursor(const Snapshot &src, const BasicScreenCorners<T> &dst_corners)
     {
         /*
         - common steps as euclidean geometry based mapping:
             calculate the screen corners based on the wii IR sensor width and the screen size
-        
-            - mapping as a homogeneous transformation steps:
-            create an 8x8 linear algebra system of equations based on 4 2d points:
-            - top left      maps to (0,0)
-            - top right     maps to (0, screen pixel width)
-            - bottom left   maps to (screen pixel height, 0)
-            - bottom right  maps to (screen pixel height, screen pixel width)
-            - 9th dimension is fixed at 1
-            
-            - this could be simplified by calling `OpenCV::getPerspectiveTransform()` which will internally
-            do the homogenous transformation at the cost of adding an additional dependency on `OpenCV`.
+
+            - mapping as a homogeneous transformation:
+            the closed form square-to-quad homographies of both quads are composed
+            (see `getPerspectiveTransformClosedForm`) and applied to the camera center only,
+            which needs no division but the final one, and keeps every step in the scalar type `T`.
         */
+        using std::abs;
+        TRACE_SPAN("LinAlgPointMapping::map_snapshot_to_cursor");
 
         if (!src.is_valid())
         {
             return std::nullopt;
         }
 
-        auto opt_corners = calculate_screen_corners(src);
+        auto opt_ir_corners = classify_ir_corners<T>(src);
+        if (!opt_ir_corners.has_value())
+        {
+            return std::nullopt;
+        }
+
+        auto ir_corners = opt_ir_corners.value();
+        auto dst = dst_corners;
+        BasicPoint<T> center{T(ir_camera_centers[0]), T(ir_camera_centers[1])};
+        T dst_scale(1);
+        if constexpr (scale_to_unit<T>)
+        {
+            constexpr T camera_scale(1.0 / (dfrobot_max_unit_x + 1));
+            ir_corners = scaled(ir_corners, camera_scale);
+            center = {center.x * camera_scale, center.y * camera_scale};
+            dst_scale = unit_scale(dst_corners);
+            dst = scaled(dst_corners, T(1) / dst_scale);
+        }
+
+        auto opt_corners = calculate_screen_corners(ir_corners);
         if (!opt_corners.has_value())
         {
             return std::nullopt;
         }
-        [[maybe_unused]] auto &src_corners = opt_corners.value();
+        const auto &src_corners = opt_corners.value();
 
-        auto opt_transform = getPerspectiveTransform(src_corners, dst_corners);
-        if (!opt_transform.has_value())
+        TRACE_SPAN("perspective_solve");
+        if (degenerate_quad(src_corners) || degenerate_quad(dst))
         {
             return std::nullopt;
         }
-        const auto &transform = opt_transform.value();
-        float3_arr ir_centers_homogenous{ir_camera_centers[0], ir_camera_centers[1], 1.0f};
 
-        const auto mapped = transform * ir_centers_homogenous;
-        if (std::fabs(mapped[2]) < std::numeric_limits<float>::epsilon())
+        // unit square coordinates of the camera center: adj(S_src) * center, then back to dst: S_dst * (u, v, w)
+        const auto unit = adjugate(square_to_quad(src_corners)) * scalar_arr<T, 3>{center.x, center.y, T(1)};
+        const auto mapped = square_to_quad(dst) * unit;
+        if (abs(mapped[2]) < std::numeric_limits<T>::epsilon())
         {
             return std::nullopt;
         }
 
-        return PointF{mapped[0]/mapped[2], mapped[1]/mapped[2]};
+        return BasicPoint<T>{mapped[0] / mapped[2] * dst_scale, mapped[1] / mapped[2] * dst_scale};
+    }
+
+    template std::optional<BasicPoint<float>> map_snapshot_to_cursor(const Snapshot &src, const BasicScreenCorners<float> &dst_corners);
+    template std::optional<BasicPoint<double>> map_snapshot_to_cursor(const Snapshot &src, const BasicScreenCorners<double> &dst_corners);
+    template std::optional<BasicPoint<Q16>> map_snapshot_to_cursor(const Snapshot &src, const BasicScreenCorners<Q16> &dst_corners);
+}
+
+namespace LinAlgPointMapping {
+    /*
+    batched mapping works on `batch_lanes` snapshots at a time, stored as structure-of-arrays so every stage
+    is a branch-free loop over lanes which the compiler vectorizes (check with `-fopt-info-vec`):
+    - validation and quadrant classification build int32 lane masks (0 or 1) and pick values with selects,
+        a lane that fails a test keeps going and is only dropped by its mask at the end
+    - the perspective solve uses the closed form square-to-quad homography (see `square_to_quad`),
+        the camera center is mapped with `S_dst * adj(S_src) * center` (the scale of the adjugate cancels out)
+    - lanes past the end of the input repeat its last snapshot, their results are never written
+    the lane count is large enough that the lane loops aren't fully unrolled, which keeps them in the loop vectorizer.
+    */
+    constexpr size_t batch_lanes = 64;
+    using lane_f = std::array<float, batch_lanes>;
+    using lane_m = std::array<int32_t, batch_lanes>;
+
+    struct SnapshotLanes {
+        std::array<lane_f, dfrobot_snapshot_size> x;
+        std::array<lane_f, dfrobot_snapshot_size> y;
+    };
+
+    struct QuadLanes {
+        lane_f top_left_x, top_left_y;
+        lane_f top_right_x, top_right_y;
+        lane_f bot_left_x, bot_left_y;
+        lane_f bot_right_x, bot_right_y;
+    };
+
+    // only the lanes of `src` are loaded, the rest keep whatever the previous batch left there and their results are
+    // never written. a snapshot is 8 consecutive uint16, so this is a plain interleaved load without a tail substitute
+    static void load_lanes(std::span<const Snapshot> src, SnapshotLanes &lanes) {
+        for (size_t lane = 0; lane < src.size(); lane++) {
+            for (size_t p = 0; p < dfrobot_snapshot_size; p++) {
+                lanes.x[p][lane] = src[lane].points[p].x;
+                lanes.y[p][lane] = src[lane].points[p].y;
+            }
+        }
+    }
+
+    // mirrors `Snapshot::is_valid`
+    static void validate_lanes(const SnapshotLanes &lanes, lane_m &valid) {
+        constexpr float max_x = dfrobot_max_unit_x;
+        constexpr float max_y = dfrobot_max_unit_y;
+        valid.fill(1);
+        for (size_t p = 0; p < dfrobot_snapshot_size; p++) {
+            for (size_t lane = 0; lane < batch_lanes; lane++) {
+                const float x = lanes.x[p][lane];
+                const float y = lanes.y[p][lane];
+                const int32_t found = (x != max_x) | (y != max_x);
+                valid[lane] &= found & (x <= max_x) & (y <= max_y);
+            }
+        }
+    }
+
+    // mirrors `calculate_screen_corners`, lanes that can't be classified into 4 corners are masked out
+    static void screen_corner_lanes(const SnapshotLanes &lanes, lane_m &valid, QuadLanes &corners) {
+        lane_f avg_x{}, avg_y{};
+        for (size_t p = 0; p < dfrobot_snapshot_size; p++) {
+            for (size_t lane = 0; lane < batch_lanes; lane++) {
+                avg_x[lane] += lanes.x[p][lane];
+                avg_y[lane] += lanes.y[p][lane];
+            }
+        }
+        for (size_t lane = 0; lane < batch_lanes; lane++) {
+            avg_x[lane] /= dfrobot_snapshot_size;
+            avg_y[lane] /= dfrobot_snapshot_size;
+        }
+
+        // the last point that falls into a quadrant wins, same as the scalar classification.
+        // the selects go to locals and are stored once per lane, selecting straight into `cam` turns them into
+        // conditional stores which don't vectorize
+        QuadLanes cam;
+        lane_m found;
+        for (size_t lane = 0; lane < batch_lanes; lane++) {
+            float tl_x = 0, tl_y = 0, tr_x = 0, tr_y = 0, bl_x = 0, bl_y = 0, br_x = 0, br_y = 0;
+            int32_t found_tl = 0, found_tr = 0, found_bl = 0, found_br = 0;
+            for (size_t p = 0; p < dfrobot_snapshot_size; p++) {
+                const float x = lanes.x[p][lane];
+                const float y = lanes.y[p][lane];
+                const int32_t left = x < avg_x[lane], right = x > avg_x[lane];
+                const int32_t top = y < avg_y[lane], bot = y > avg_y[lane];
+
+                tl_x = (left & top) ? x : tl_x;
+                tl_y = (left & top) ? y : tl_y;
+                tr_x = (right & top) ? x : tr_x;
+                tr_y = (right & top) ? y : tr_y;
+                bl_x = (left & bot) ? x : bl_x;
+                bl_y = (left & bot) ? y : bl_y;
+                br_x = (right & bot) ? x : br_x;
+                br_y = (right & bot) ? y : br_y;
+
+                found_tl |= left & top;
+                found_tr |= right & top;
+                found_bl |= left & bot;
+                found_br |= right & bot;
+            }
+            cam.top_left_x[lane] = tl_x;
+            cam.top_left_y[lane] = tl_y;
+            cam.top_right_x[lane] = tr_x;
+            cam.top_right_y[lane] = tr_y;
+            cam.bot_left_x[lane] = bl_x;
+            cam.bot_left_y[lane] = bl_y;
+            cam.bot_right_x[lane] = br_x;
+            cam.bot_right_y[lane] = br_y;
+            found[lane] = found_tl & found_tr & found_bl & found_br;
+        }
+
+        // extend the horizontal IR pairs to the screen width, see `calculate_corners` in mapping_common.cpp.
+        // left and right points of a classified lane are strictly on both sides of the average, so the lines are
+        // never vertical, an unclassified lane may divide by zero but is masked out
+        constexpr float screen_half_width_cm = screen_width_cm / 2;
+        auto extend = [](float left_x, float left_y, float right_x, float right_y,
+                         float &out_left_x, float &out_left_y, float &out_right_x, float &out_right_y) {
+            const float m = (left_y - right_y) / (left_x - right_x);
+            const float n = left_y - m * left_x;
+            const float avg_x = (left_x + right_x) / 2;
+            const float ratio = (right_x - avg_x) / (wii_ir_led_width_cm / 2);
+            const float x_diff = std::fabs(screen_half_width_cm * ratio);
+            out_left_x = avg_x - x_diff;
+            out_right_x = avg_x + x_diff;
+            out_left_y = m * out_left_x + n;
+            out_right_y = m * out_right_x + n;
+        };
+
+        for (size_t lane = 0; lane < batch_lanes; lane++) {
+            valid[lane] &= found[lane];
+            extend(cam.top_left_x[lane], cam.top_left_y[lane], cam.top_right_x[lane], cam.top_right_y[lane],
+                   corners.top_left_x[lane], corners.top_left_y[lane], corners.top_right_x[lane], corners.top_right_y[lane]);
+            extend(cam.bot_left_x[lane], cam.bot_left_y[lane], cam.bot_right_x[lane], cam.bot_right_y[lane],
+                   corners.bot_left_x[lane], corners.bot_left_y[lane], corners.bot_right_x[lane], corners.bot_right_y[lane]);
+        }
+    }
+
+    // `collinear` as a lane mask
+    static inline int32_t collinear_lane(float ax, float ay, float bx, float by, float cx, float cy) {
+        const float lhs = (bx - ax) * (cy - ay);
+        const float rhs = (by - ay) * (cx - ax);
+        return std::fabs(lhs - rhs) <= std::numeric_limits<float>::epsilon() * (std::fabs(lhs) + std::fabs(rhs));
+    }
+
+    // maps the camera center through the src quad to dst homography, degenerate lanes are masked out
+    static void perspective_lanes(const QuadLanes &src, const float3_mat &dst, lane_m &valid, lane_f &out_x, lane_f &out_y) {
+        constexpr float center_x = ir_camera_centers[0];
+        constexpr float center_y = ir_camera_centers[1];
+        constexpr float max = std::numeric_limits<float>::max();
+
+        for (size_t lane = 0; lane < batch_lanes; lane++) {
+            // same as `square_to_quad`, inlined per lane
+            const float x0 = src.top_left_x[lane], y0 = src.top_left_y[lane];
+            const float x1 = src.top_right_x[lane], y1 = src.top_right_y[lane];
+            const float x2 = src.bot_right_x[lane], y2 = src.bot_right_y[lane];
+            const float x3 = src.bot_left_x[lane], y3 = src.bot_left_y[lane];
+
+            const int32_t degenerate = collinear_lane(x0, y0, x1, y1, x2, y2) | collinear_lane(x1, y1, x2, y2, x3, y3) |
+                                       collinear_lane(x2, y2, x3, y3, x0, y0) | collinear_lane(x3, y3, x0, y0, x1, y1);
+
+            const float sx = x0 - x1 + x2 - x3;
+            const float sy = y0 - y1 + y2 - y3;
+            const float dx1 = x1 - x2, dx2 = x3 - x2;
+            const float dy1 = y1 - y2, dy2 = y3 - y2;
+            const float den = dx1 * dy2 - dx2 * dy1;
+
+            const float g = (sx * dy2 - dx2 * sy) / den;
+            const float h = (dx1 * sy - sx * dy1) / den;
+            const float a = x1 - x0 + g * x1, b = x3 - x0 + h * x3, c = x0;
+            const float d = y1 - y0 + g * y1, e = y3 - y0 + h * y3, f = y0;
+
+            // unit square coordinates of the camera center: adj(S_src) * center
+            const float u = (e - f * h) * center_x + (c * h - b) * center_y + (b * f - c * e);
+            const float v = (f * g - d) * center_x + (a - c * g) * center_y + (c * d - a * f);
+            const float w = (d * h - e * g) * center_x + (b * g - a * h) * center_y + (a * e - b * d);
+
+            // back to screen coordinates: S_dst * (u, v, w)
+            const float X = dst[0][0] * u + dst[0][1] * v + dst[0][2] * w;
+            const float Y = dst[1][0] * u + dst[1][1] * v + dst[1][2] * w;
+            const float Z = dst[2][0] * u + dst[2][1] * v + dst[2][2] * w;
+            out_x[lane] = X / Z;
+            out_y[lane] = Y / Z;
+
+            // a non finite result means the center was mapped to infinity
+            const int32_t finite = (std::fabs(out_x[lane]) <= max) & (std::fabs(out_y[lane]) <= max);
+            valid[lane] &= (degenerate ^ 1) & finite;
+        }
+    }
+
+    void map_snapshots_to_cursors(std::span<const Snapshot> src, const ScreenCorners &dst_corners,
+                                  std::span<PointF> cursors, std::span<uint8_t> valid)
+    {
+        // the only check outside the lanes, an undersized output would be written past its end
+        if (cursors.size() < src.size() || valid.size() < src.size())
+        {
+            printf("Error: %zu snapshots to map into %zu cursors and %zu valid flags\n", src.size(), cursors.size(), valid.size());
+            std::ranges::fill(valid.first(std::min(valid.size(), src.size())), 0);
+            return;
+        }
+
+        if (degenerate_quad(dst_corners))
+        {
+            std::ranges::fill(valid.first(src.size()), 0);
+            return;
+        }
+        const float3_mat dst = square_to_quad(dst_corners);
+
+        SnapshotLanes lanes{};
+        QuadLanes corners;
+        lane_m lane_valid;
+        lane_f out_x, out_y;
+        for (size_t offset = 0; offset < src.size(); offset += batch_lanes) {
+            const auto batch = src.subspan(offset, std::min(batch_lanes, src.size() - offset));
+
+            load_lanes(batch, lanes);
+            validate_lanes(lanes, lane_valid);
+            screen_corner_lanes(lanes, lane_valid, corners);
+            perspective_lanes(corners, dst, lane_valid, out_x, out_y);
+
+            // an unmapped cursor is written back unchanged, blended on the bits so the store stays unconditional
+            PointF *batch_cursors = cursors.data() + offset;
+            uint8_t *batch_valid = valid.data() + offset;
+            for (size_t lane = 0; lane < batch.size(); lane++) {
+                const uint32_t keep = static_cast<uint32_t>(lane_valid[lane]) - 1;
+                const uint32_t x = std::bit_cast<uint32_t>(out_x[lane]), old_x = std::bit_cast<uint32_t>(batch_cursors[lane].x);
+                const uint32_t y = std::bit_cast<uint32_t>(out_y[lane]), old_y = std::bit_cast<uint32_t>(batch_cursors[lane].y);
+                batch_cursors[lane].x = std::bit_cast<float>((x & ~keep) | (old_x & keep));
+                batch_cursors[lane].y = std::bit_cast<float>((y & ~keep) | (old_y & keep));
+                batch_valid[lane] = static_cast<uint8_t>(lane_valid[lane]);
+            }
+        }
     }
 }
@@ -0,0 +1,88 @@
+#include <format>
+#include <utility>
+#include "LiveStats.h"
+
+namespace
+{
+    std::string histogram_summary(const char *name, const LatencyHistogram &histogram)
+    {
+        const auto counts = histogram.counts();
+        return std::format("{} p50: {:.2f} ms, p99: {:.2f} ms, max: {:.2f} ms", name,
+            counts.percentile_ms(0.5), counts.percentile_ms(0.99), counts.max_ms());
+    }
+}
+
+std::string LiveStats::summary() const
+{
+    // with several guns the render thread records only some of the metrics, the rest stay empty
+    std::string result;
+    const std::array<std::pair<const char *, const LatencyHistogram *>, 5> histograms{{
+        {"acquisition", &acquisition}, {"mapping", &mapping}, {"render", &render},
+        {"end to end", &end_to_end}, {"frame time", &frame_time}}};
+    for (const auto &[name, histogram] : histograms)
+    {
+        if (histogram->count() > 0)
+        {
+            result += histogram_summary(name, *histogram) + ", ";
+        }
+    }
+    return result + std::format("invalid frames: {}, failed frames: {}",
+        invalid_frames.load(std::memory_order_relaxed), failed_frames.load(std::memory_order_relaxed));
+}
+
+LiveStatsWindow::LiveStatsWindow(const LiveStats &stats)
+    : LiveStatsWindow(std::vector<const LiveStats *>{&stats})
+{
+}
+
+LiveStatsWindow::LiveStatsWindow(std::vector<const LiveStats *> sources)
+    : sources(std::move(sources)), last_update(LiveStats::clock::now())
+{
+}
+
+bool LiveStatsWindow::update(LiveStats::clock::time_point now)
+{
+    const auto elapsed = now - last_update;
+    if (elapsed < interval)
+    {
+        return false;
+    }
+    last_update = now;
+
+    constexpr std::array<LatencyHistogram LiveStats::*, 5> histograms{
+        &LiveStats::acquisition, &LiveStats::mapping, &LiveStats::render, &LiveStats::end_to_end, &LiveStats::frame_time};
+    std::array<LatencyHistogram::Counts, 5> window;
+    uint64_t invalid = 0;
+    uint64_t failed = 0;
+    for (size_t i = 0; i < histograms.size(); i++)
+    {
+        LatencyHistogram::Counts counts;
+        for (const LiveStats *stats : sources)
+        {
+            counts += (stats->*histograms[i]).counts();
+        }
+        window[i] = counts.since(previous[i]);
+        previous[i] = counts;
+    }
+    for (const LiveStats *stats : sources)
+    {
+        invalid += stats->invalid_frames.load(std::memory_order_relaxed);
+        failed += stats->failed_frames.load(std::memory_order_relaxed);
+    }
+
+    const double fps = window[4].count / std::chrono::duration<double>(elapsed).count();
+    auto out = std::format_to_n(buffer.data(), buffer.size(), "FPS {:.1f}\n{:<4}{:>7}{:>7}{:>7}\n", fps, "MS", "P50", "P99", "MAX").out;
+    const std::array<const char *, 4> names{"ACQ", "MAP", "RND", "E2E"};
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        const auto remaining = buffer.size() - static_cast<size_t>(out - buffer.data());
+        out = std::format_to_n(out, remaining, "{:<4}{:>7.2f}{:>7.2f}{:>7.2f}\n", names[i],
+            window[i].percentile_ms(0.5), window[i].percentile_ms(0.99), window[i].max_ms()).out;
+    }
+    const auto remaining = buffer.size() - static_cast<size_t>(out - buffer.data());
+    out = std::format_to_n(out, remaining, "INVALID {} FAILED {}", invalid - previous_invalid, failed - previous_failed).out;
+    length = static_cast<size_t>(out - buffer.data());
+    previous_invalid = invalid;
+    previous_failed = failed;
+    return true;
+}
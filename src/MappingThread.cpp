@@ -0,0 +1,62 @@
+#include <cstdio>
+#include "MappingThread.h"
+#include "Trace.h"
+
+MappingThread::MappingThread(IDataAcq *data_acq, const ScreenCorners &screen_corners, bool debug_mode, float reuse_tolerance,
+                             std::unique_ptr<ICursorFilter> cursor_filter, bool track_partial_visibility, LiveStats *live_stats)
+    : acquisition(data_acq, live_stats),
+      mapper(screen_corners, debug_mode, reuse_tolerance, std::move(cursor_filter), track_partial_visibility, live_stats),
+      debug_mode(debug_mode)
+{
+    // started last, every member it uses is initialized
+    thread = std::jthread([this](std::stop_token stop_token) { run(stop_token); });
+}
+
+MappingThread::~MappingThread()
+{
+    stop();
+}
+
+void MappingThread::stop()
+{
+    if (thread.joinable())
+    {
+        thread.request_stop();
+        thread.join();
+    }
+    acquisition.stop();
+}
+
+bool MappingThread::update()
+{
+    return output.update();
+}
+
+const MappedFrame &MappingThread::frame() const
+{
+    return output.read_buffer();
+}
+
+void MappingThread::run(std::stop_token stop_token)
+{
+    Trace::set_thread_name("mapping");
+    while (!stop_token.stop_requested())
+    {
+        auto frame = acquisition.wait_latest(stop_token);
+        if (!frame.has_value())
+        {
+            // stopped while waiting
+            continue;
+        }
+
+        if (debug_mode)
+        {
+            auto stats = acquisition.stats();
+            printf("Snapshot: %s (acquired: %llu, dropped: %llu, stale: %llu, duplicate: %llu)\n", frame->snapshot.to_string().c_str(),
+                static_cast<unsigned long long>(stats.acquired), static_cast<unsigned long long>(stats.dropped),
+                static_cast<unsigned long long>(stats.stale), static_cast<unsigned long long>(stats.duplicate));
+        }
+        mapper.map(frame->snapshot, frame->capture_time, output.write_buffer());
+        output.publish();
+    }
+}
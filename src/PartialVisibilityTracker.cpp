@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "PartialVisibilityTracker.h"
+
+namespace
+{
+    using Quad = std::array<PointF, 4>;
+
+    // the sensor reports a point it doesn't see as (1023, 1023), see `Snapshot::is_valid`
+    bool is_visible(const Point &point)
+    {
+        return !(point.x == dfrobot_max_unit_x && point.y == dfrobot_max_unit_x) && point.x <= dfrobot_max_unit_x && point.y <= dfrobot_max_unit_y;
+    }
+
+    PointF center(const Quad &quad)
+    {
+        PointF sum{0, 0};
+        for (const auto &point : quad)
+        {
+            sum.x += point.x;
+            sum.y += point.y;
+        }
+        return {sum.x / quad.size(), sum.y / quad.size()};
+    }
+
+    float distance_squared(const PointF &a, const PointF &b)
+    {
+        return (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y);
+    }
+
+    // x' = m00 x + m01 y + tx, y' = m10 x + m11 y + ty
+    struct Affine
+    {
+        float m00, m01, m10, m11;
+        float tx, ty;
+
+        PointF apply(const PointF &point) const
+        {
+            return {m00 * point.x + m01 * point.y + tx, m10 * point.x + m11 * point.y + ty};
+        }
+    };
+
+    Affine with_translation(float m00, float m01, float m10, float m11, const PointF &from, const PointF &to)
+    {
+        return {m00, m01, m10, m11, to.x - (m00 * from.x + m01 * from.y), to.y - (m10 * from.x + m11 * from.y)};
+    }
+
+    // rotation, uniform scale and translation taking `from` onto `to`, nullopt if the `from` points coincide
+    std::optional<Affine> similarity(const std::array<PointF, 2> &from, const std::array<PointF, 2> &to)
+    {
+        const PointF u{from[1].x - from[0].x, from[1].y - from[0].y};
+        const PointF v{to[1].x - to[0].x, to[1].y - to[0].y};
+        const float length_squared = u.x * u.x + u.y * u.y;
+        if (length_squared < 1.0f)
+        {
+            return std::nullopt;
+        }
+        // the complex ratio v / u
+        const float re = (v.x * u.x + v.y * u.y) / length_squared;
+        const float im = (v.y * u.x - v.x * u.y) / length_squared;
+        return with_translation(re, -im, im, re, from[0], to[0]);
+    }
+
+    // the affine transform taking `from` onto `to`, nullopt if the `from` points are collinear
+    std::optional<Affine> affine(const std::array<PointF, 3> &from, const std::array<PointF, 3> &to)
+    {
+        const PointF u{from[1].x - from[0].x, from[1].y - from[0].y};
+        const PointF v{from[2].x - from[0].x, from[2].y - from[0].y};
+        const PointF U{to[1].x - to[0].x, to[1].y - to[0].y};
+        const PointF V{to[2].x - to[0].x, to[2].y - to[0].y};
+        const float det = u.x * v.y - u.y * v.x;
+        if (std::fabs(det) < 1.0f)
+        {
+            return std::nullopt;
+        }
+        // M [u v] = [U V]
+        return with_translation((U.x * v.y - V.x * u.y) / det, (V.x * u.x - U.x * v.x) / det,
+                                (U.y * v.y - V.y * u.y) / det, (V.y * u.x - U.y * v.x) / det, from[0], to[0]);
+    }
+}
+
+namespace LinAlgPointMapping {
+    PartialVisibilityTracker::PartialVisibilityTracker()
+        : PartialVisibilityTracker(Params{})
+    {
+    }
+
+    PartialVisibilityTracker::PartialVisibilityTracker(Params params)
+        : _params(params)
+    {
+    }
+
+    void PartialVisibilityTracker::reset()
+    {
+        _corners.reset();
+        _motion = {0, 0};
+        _coasted_frames = 0;
+        _partial_frames = 0;
+    }
+
+    void PartialVisibilityTracker::coast()
+    {
+        if (!_corners.has_value())
+        {
+            return;
+        }
+        if (++_partial_frames > _params.max_partial_frames)
+        {
+            reset();
+            return;
+        }
+        // `_corners` stay the last measured quad, the prediction extrapolates over the coasted frames
+        _coasted_frames++;
+    }
+
+    std::optional<PartialVisibilityTracker::Quad> PartialVisibilityTracker::complete(const Snapshot &src) const
+    {
+        if (!_corners.has_value() || _partial_frames >= _params.max_partial_frames)
+        {
+            return std::nullopt;
+        }
+
+        std::array<PointF, 4> visible;
+        size_t count = 0;
+        for (const auto &point : src.points)
+        {
+            if (is_visible(point))
+            {
+                visible[count++] = {static_cast<float>(point.x), static_cast<float>(point.y)};
+            }
+        }
+        if (count < 2)
+        {
+            return std::nullopt;
+        }
+
+        // where the corners are expected now, if the quad kept moving like in the last measured frames
+        const auto frames = static_cast<float>(_coasted_frames + 1);
+        Quad predicted = _corners.value();
+        for (auto &corner : predicted)
+        {
+            corner.x += _motion.x * frames;
+            corner.y += _motion.y * frames;
+        }
+
+        // the closest assignment of the visible points to distinct corners, at most 4! candidates
+        const float max_distance_squared = _params.max_match_distance * _params.max_match_distance;
+        std::array<size_t, 4> slots;
+        std::iota(slots.begin(), slots.end(), 0);
+        std::optional<std::array<size_t, 4>> best_slots;
+        float best_cost = INFINITY;
+        do
+        {
+            float cost = 0;
+            for (size_t i = 0; i < count && cost < INFINITY; i++)
+            {
+                float d = distance_squared(visible[i], predicted[slots[i]]);
+                cost = d > max_distance_squared ? INFINITY : cost + d;
+            }
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_slots = slots;
+            }
+        } while (std::next_permutation(slots.begin(), slots.end()));
+
+        if (!best_slots.has_value())
+        {
+            return std::nullopt;
+        }
+        const auto &matched = best_slots.value();
+
+        // move the missing corners along with the visible ones
+        std::optional<Affine> transform;
+        if (count == 3)
+        {
+            transform = affine({predicted[matched[0]], predicted[matched[1]], predicted[matched[2]]},
+                               {visible[0], visible[1], visible[2]});
+        }
+        else if (count == 2)
+        {
+            transform = similarity({predicted[matched[0]], predicted[matched[1]]}, {visible[0], visible[1]});
+            if (transform.has_value())
+            {
+                // a big jump in scale means the points were matched to the wrong corners
+                float scale = std::hypot(transform->m00, transform->m10);
+                if (scale > _params.max_scale_change || scale * _params.max_scale_change < 1)
+                {
+                    return std::nullopt;
+                }
+            }
+        }
+        if (count < 4 && !transform.has_value())
+        {
+            return std::nullopt;
+        }
+
+        Quad completed = predicted;
+        if (transform.has_value())
+        {
+            for (auto &corner : completed)
+            {
+                corner = transform->apply(corner);
+            }
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            completed[matched[i]] = visible[i];
+        }
+        return completed;
+    }
+
+    MappingResult<PartialVisibilityTracker::Result> PartialVisibilityTracker::map_snapshot_to_cursor(const Snapshot &src, const ScreenCorners &dst_corners)
+    {
+        _stats.frames++;
+        const auto visible = static_cast<uint32_t>(std::ranges::count_if(src.points, is_visible));
+
+        std::optional<Quad> quad;
+        bool full = false;
+        if (visible == dfrobot_snapshot_size)
+        {
+            auto classified = classify_ir_corners(src);
+            if (classified.has_value())
+            {
+                quad = Quad{classified->top_left, classified->top_right, classified->bot_left, classified->bot_right};
+                full = true;
+            }
+        }
+        if (!quad.has_value())
+        {
+            quad = complete(src);
+        }
+
+        // a partial frame the track couldn't complete is invalid, like without tracking
+        MappingResult<PointF> cursor = std::unexpected(visible == dfrobot_snapshot_size ? MappingError::CornerClassification : MappingError::InvalidSnapshot);
+        if (quad.has_value())
+        {
+            const auto &ir = quad.value();
+            auto screen_corners = calculate_screen_corners(ScreenCorners(ir[0], ir[1], ir[2], ir[3]));
+            if (!screen_corners.has_value())
+            {
+                cursor = std::unexpected(screen_corners.error());
+            }
+            else
+            {
+                auto transform = getPerspectiveTransform(screen_corners.value(), dst_corners);
+                auto center = transform.has_value() ? map_camera_center(transform.value()) : std::nullopt;
+                cursor = center.has_value() ? MappingResult<PointF>(center.value()) : std::unexpected(MappingError::DivisionByZero);
+            }
+        }
+        if (!cursor.has_value())
+        {
+            coast();
+            _stats.lost++;
+            return std::unexpected(cursor.error());
+        }
+
+        if (_corners.has_value())
+        {
+            // per frame since the last measured quad, frames without a cursor in between only coasted
+            auto from = center(_corners.value());
+            auto to = center(quad.value());
+            const auto frames = static_cast<float>(_coasted_frames + 1);
+            _motion = {(to.x - from.x) / frames, (to.y - from.y) / frames};
+        }
+        _corners = quad;
+        _coasted_frames = 0;
+        _partial_frames = full ? 0 : _partial_frames + 1;
+
+        if (full)
+        {
+            _stats.full++;
+        }
+        else if (visible == dfrobot_snapshot_size)
+        {
+            _stats.recovered_4++;
+        }
+        else if (visible == 3)
+        {
+            _stats.recovered_3++;
+        }
+        else
+        {
+            _stats.recovered_2++;
+        }
+
+        float confidence = 1;
+        if (!full)
+        {
+            confidence = static_cast<float>(visible) / dfrobot_snapshot_size *
+                         (1 - static_cast<float>(_partial_frames - 1) / _params.max_partial_frames);
+        }
+        return Result{cursor.value(), confidence, visible};
+    }
+};
@@ -1,20 +1,19 @@
 #include <optional>
-#include <exception>
-#include <format>
 #include "PointMapping.h"
 #include "consts.h"
 #include "SafeDivide.h"
 #include "Geometry.h"
 #include "mapping_common.h"
+#include "Trace.h"
 
 namespace
 {
-    borders calculate_borders(const Snapshot &snapshot)
+    MappingResult<borders> calculate_borders(const Snapshot &snapshot)
     {
         auto opt_corners = calculate_screen_corners(snapshot);
         if (!opt_corners.has_value())
         {
-            throw std::runtime_error(std::format("Failed to calculate the screen corners for snapshot {}", snapshot.to_string()));
+            return std::unexpected(opt_corners.error());
         }
         const auto &corners = opt_corners.value();
 
@@ -30,7 +29,7 @@ namespace
 
         if (!opt_top_line.has_value() || !opt_bot_line.has_value() || !opt_left_line.has_value() || !opt_right_line.has_value())
         {
-            throw std::runtime_error("Failed to calculate the screen border lines");
+            return std::unexpected(MappingError::DegenerateLine);
         }
 
         const Line &top_line = opt_top_line.value();
@@ -44,39 +43,43 @@ namespace
             const PointF &line1_start,
             const Line &Line2,
             const PointF &line2_start,
-            const PointF &camera_point) -> float
+            const PointF &camera_point) -> MappingResult<float>
         {
             if (line1.is_vertical() || Line2.is_vertical())
             {
-                throw std::runtime_error("one of the lines is vertical");
+                return std::unexpected(MappingError::VerticalLine);
             }
 
-            PointF slope_start = {line1_start.y, line1._m.value()};
-            PointF slope_end = {line2_start.y, Line2._m.value()};
+            PointF slope_start = {line1_start.y, line1.slope().value()};
+            PointF slope_end = {line2_start.y, Line2.slope().value()};
 
             auto opt_slope_line = Line::from_points(slope_start, slope_end);
             if (!opt_slope_line.has_value())
             {
-                throw std::runtime_error("Failed to calculate the slope line");
+                return std::unexpected(MappingError::DegenerateLine);
             }
             const Line &slope_line = opt_slope_line.value();
 
             auto opt_slope = slope_line.y(camera_point.y);
             if (!opt_slope.has_value())
             {
-                throw std::runtime_error("Failed to calculate the slope");
+                return std::unexpected(MappingError::VerticalLine);
             }
             return opt_slope.value();
         };
 
         // vertical position compensation
         constexpr PointF ir_camera_mid = {static_cast<float>(ir_camera_centers[0]), static_cast<float>(ir_camera_centers[1])};
-        float horizontal_intersection_slope = compensated_slope(
+        auto opt_horizontal_intersection_slope = compensated_slope(
             top_line, screen_top_left,
             bot_line, screen_bot_left,
             ir_camera_mid);
+        if (!opt_horizontal_intersection_slope.has_value())
+        {
+            return std::unexpected(opt_horizontal_intersection_slope.error());
+        }
 
-        Line horizontal_camera_line = Line(ir_camera_mid, horizontal_intersection_slope);
+        Line horizontal_camera_line = Line(ir_camera_mid, opt_horizontal_intersection_slope.value());
 
         // horizontal position compensation
         // to avoid handling vertical lines (with undefined slope), we calculate with inverted x and y axis
@@ -90,21 +93,24 @@ namespace
         auto opt_bot_line_inverted = Line::from_points(screen_bot_left_inverted, screen_bot_right_inverted);
         if (!opt_left_line_inverted.has_value() || !opt_right_line_inverted.has_value() || !opt_bot_line_inverted.has_value())
         {
-            throw std::runtime_error("Failed to calculate the inverted screen lines");
+            return std::unexpected(MappingError::DegenerateLine);
         }
         const Line &left_line_inverted = opt_left_line_inverted.value();
         const Line &right_line_inverted = opt_right_line_inverted.value();
 
         constexpr PointF ir_camera_mid_inverted = {ir_camera_mid.y, ir_camera_mid.x};
 
-        float inverted_vertical_intersection_slope = compensated_slope(
+        auto opt_inverted_vertical_intersection_slope = compensated_slope(
             left_line_inverted, screen_top_left_inverted,
             right_line_inverted, screen_top_right_inverted,
             ir_camera_mid_inverted);
+        if (!opt_inverted_vertical_intersection_slope.has_value())
+        {
+            return std::unexpected(opt_inverted_vertical_intersection_slope.error());
+        }
 
-        float vertical_intersection_slope = SafeDivide(1.0F, inverted_vertical_intersection_slope);
-
-        Line vertical_camera_line = Line(ir_camera_mid, vertical_intersection_slope);
+        // a zero inverted slope is a vertical camera line, which the homogeneous line represents directly
+        Line vertical_camera_line = Line::from_inverted_slope(ir_camera_mid, opt_inverted_vertical_intersection_slope.value());
 
         auto opt_intersect_top = vertical_camera_line.intersection(top_line);
         auto opt_intersect_bot = vertical_camera_line.intersection(bot_line);
@@ -112,7 +118,7 @@ namespace
         auto opt_intersect_right = horizontal_camera_line.intersection(right_line);
         if (!opt_intersect_top.has_value() || !opt_intersect_bot.has_value() || !opt_intersect_left.has_value() || !opt_intersect_right.has_value())
         {
-            throw std::runtime_error("Failed to calculate the intersection points");
+            return std::unexpected(MappingError::NoIntersection);
         }
 
         LineSegment top_segment(screen_top_left, screen_top_right);
@@ -122,7 +128,7 @@ namespace
         LineSegment cursor_horizontal(opt_intersect_left.value(), opt_intersect_right.value());
         LineSegment cursor_vertical(opt_intersect_top.value(), opt_intersect_bot.value());
 
-        return {corners,
+        return borders{corners,
                 top_line,
                 bot_line,
                 left_line,
@@ -137,11 +143,16 @@ namespace
                 cursor_vertical};
     }
 
-    PointF map(const Snapshot &snapshot, const ScreenCorners &screen_corners)
+    MappingResult<PointF> map(const Snapshot &snapshot, const ScreenCorners &screen_corners)
     {
         PointF result;
 
-        borders screen_borders = calculate_borders(snapshot); 
+        auto opt_screen_borders = calculate_borders(snapshot);
+        if (!opt_screen_borders.has_value())
+        {
+            return std::unexpected(opt_screen_borders.error());
+        }
+        borders &screen_borders = opt_screen_borders.value();
 
         auto &vertical_camera_line = screen_borders.cursor_vertical;
         auto &horizontal_camera_line = screen_borders.cursor_horizontal;
@@ -155,20 +166,26 @@ namespace
         auto opt_intersect_vertical = vertical_camera_line.intersection(bot_line);
         if (!opt_intersect_vertical.has_value())
         {
-            throw std::runtime_error("Failed to calculate the horizontal intersection point");
+            return std::unexpected(MappingError::NoIntersection);
         }
         const PointF &intersect_bot = opt_intersect_vertical.value();
 
         auto opt_intersect_horizontal = horizontal_camera_line.intersection(left_line);
         if (!opt_intersect_horizontal.has_value())
         {
-            throw std::runtime_error("Failed to calculate the vertical intersection point");
+            return std::unexpected(MappingError::NoIntersection);
         }
         const PointF &intersect_left = opt_intersect_horizontal.value();
 
         // // calculate the percentage of the intersection points relative to the screen pixels
-        float x_percentage = SafeDivide((intersect_bot.x - screen_top_left.x), (screen_top_right.x - screen_top_left.x));
-        float y_percentage = SafeDivide((intersect_left.y - screen_top_left.y), (screen_bot_left.y - screen_top_left.y));
+        auto opt_x_percentage = SafeDivide((intersect_bot.x - screen_top_left.x), (screen_top_right.x - screen_top_left.x));
+        auto opt_y_percentage = SafeDivide((intersect_left.y - screen_top_left.y), (screen_bot_left.y - screen_top_left.y));
+        if (!opt_x_percentage.has_value() || !opt_y_percentage.has_value())
+        {
+            return std::unexpected(MappingError::DivisionByZero);
+        }
+        float x_percentage = opt_x_percentage.value();
+        float y_percentage = opt_y_percentage.value();
 
         // // calculate the cursor
         const auto screen_width = screen_corners.top_right.x - screen_corners.top_left.x;
@@ -183,17 +200,10 @@ namespace
     }
 }
 
-std::optional<PointF> map_snapshot_to_cursor(const Snapshot &snapshot, const ScreenCorners &screen_corners)
+MappingResult<PointF> map_snapshot_to_cursor(const Snapshot &snapshot, const ScreenCorners &screen_corners)
 {
-    try
-    {
-        return map(snapshot, screen_corners);
-    }
-    catch (const std::exception &e)
-    {
-        printf("Error: %s\n", e.what());
-    }
-    return std::nullopt;
+    TRACE_SPAN("PointMapping::map_snapshot_to_cursor");
+    return map(snapshot, screen_corners);
 }
 
 PointF map_snapshot_debug(const Point &point, const screen_constants &constants)
@@ -207,15 +217,7 @@ PointF map_snapshot_debug(const Point &point, const screen_constants &constants)
     return {x_mapped, y_mapped};
 }
 
-std::optional<borders> map_snapshot_to_borders(const Snapshot &snapshot)
+MappingResult<borders> map_snapshot_to_borders(const Snapshot &snapshot)
 {
-    try
-    {
-        return calculate_borders(snapshot);
-    }
-    catch (const std::exception &e)
-    {
-        printf("Error: %s\n", e.what());
-    }
-    return std::nullopt;
+    return calculate_borders(snapshot);
 }
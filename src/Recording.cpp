@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <cstdio>
+#include <format>
+#include "Recording.h"
+
+namespace Recording {
+    static Header make_header(uint32_t fps, bool with_timestamps)
+    {
+        Header header{};
+        header.magic = magic;
+        header.version = format_version;
+        header.flags = with_timestamps ? HasTimestamps : 0;
+        header.fps = fps;
+        header.snapshot_size = dfrobot_snapshot_size;
+        header.max_unit_x = dfrobot_max_unit_x;
+        header.max_unit_y = dfrobot_max_unit_y;
+        header.frame_count = 0;
+        return header;
+    }
+
+    std::optional<std::string> validate(const Header &header, size_t file_size)
+    {
+        if (header.magic != magic)
+        {
+            return "not a binary recording";
+        }
+        if (header.version != format_version)
+        {
+            return std::format("unsupported format version {}", header.version);
+        }
+        if (header.snapshot_size != dfrobot_snapshot_size || header.max_unit_x != dfrobot_max_unit_x || header.max_unit_y != dfrobot_max_unit_y)
+        {
+            return "recorded with different sensor constants";
+        }
+
+        const size_t record_size = sizeof(FrameRecord) + ((header.flags & HasTimestamps) ? sizeof(Timestamp) : 0);
+        if (file_size < sizeof(Header) || (file_size - sizeof(Header)) / record_size < header.frame_count)
+        {
+            return std::format("truncated file, expected {} frames", header.frame_count);
+        }
+        return std::nullopt;
+    }
+
+    bool is_binary_recording(const std::string &file_name)
+    {
+        std::ifstream input(file_name, std::ios::binary);
+        std::array<char, magic.size()> file_magic{};
+        return input.read(file_magic.data(), file_magic.size()) && file_magic == magic;
+    }
+
+    Writer::Writer(const std::string &file_name, uint32_t fps, bool with_timestamps)
+        : output(file_name, std::ios::binary | std::ios::trunc),
+          header(make_header(fps, with_timestamps))
+    {
+        if (!output.is_open())
+        {
+            printf("Failed to open file %s\n", file_name.c_str());
+            return;
+        }
+        // placeholder, rewritten with the frame count every `header_interval` frames and on close
+        Header placeholder = header;
+        placeholder.flags = 0;
+        output.write(reinterpret_cast<const char *>(&placeholder), sizeof(placeholder));
+    }
+
+    Writer::~Writer()
+    {
+        close();
+    }
+
+    bool Writer::is_open() const
+    {
+        return output.is_open();
+    }
+
+    bool Writer::write_header(uint16_t flags)
+    {
+        Header on_disk = header;
+        on_disk.flags = flags;
+        const auto end = output.tellp();
+        output.seekp(0, std::ios::beg);
+        output.write(reinterpret_cast<const char *>(&on_disk), sizeof(on_disk));
+        output.seekp(end);
+        output.flush();
+        return output.good();
+    }
+
+    bool Writer::write(const Snapshot &snapshot, Timestamp timestamp_us)
+    {
+        output.write(reinterpret_cast<const char *>(&snapshot), sizeof(FrameRecord));
+        if (header.flags & HasTimestamps)
+        {
+            timestamps.push_back(timestamp_us);
+        }
+        header.frame_count++;
+
+        // the timestamp column only exists after close, until then the header claims none
+        if (header.frame_count % header_interval == 0)
+        {
+            return write_header(header.flags & ~HasTimestamps);
+        }
+        return output.good();
+    }
+
+    bool Writer::close()
+    {
+        if (!output.is_open())
+        {
+            return false;
+        }
+
+        output.write(reinterpret_cast<const char *>(timestamps.data()), timestamps.size() * sizeof(Timestamp));
+        bool written = write_header(header.flags);
+        output.close();
+        return written && !output.fail();
+    }
+
+    std::optional<uint64_t> convert_text_recording(const std::string &text_file_name, const std::string &binary_file_name, uint32_t fps)
+    {
+        std::ifstream input(text_file_name);
+        if (!input.is_open())
+        {
+            printf("Failed to open file %s\n", text_file_name.c_str());
+            return std::nullopt;
+        }
+
+        Writer writer(binary_file_name, fps, false);
+        if (!writer.is_open())
+        {
+            return std::nullopt;
+        }
+
+        std::string line;
+        uint64_t line_number = 0;
+        uint64_t frames = 0;
+        while (std::getline(input, line))
+        {
+            line_number++;
+            if (line.empty())
+            {
+                continue;
+            }
+
+            auto snapshot = parse_snapshot(line);
+            if (!snapshot.has_value())
+            {
+                printf("%s:%llu: %s\n", text_file_name.c_str(), static_cast<unsigned long long>(line_number), to_string(snapshot.error()));
+                return std::nullopt;
+            }
+            if (!writer.write(snapshot.value()))
+            {
+                printf("Failed to write %s\n", binary_file_name.c_str());
+                return std::nullopt;
+            }
+            frames++;
+        }
+        if (!writer.close())
+        {
+            printf("Failed to write %s\n", binary_file_name.c_str());
+            return std::nullopt;
+        }
+        return frames;
+    }
+
+    std::optional<std::vector<Snapshot>> load_snapshots(const std::string &file_name)
+    {
+        std::ifstream input(file_name, std::ios::binary | std::ios::ate);
+        if (!input.is_open())
+        {
+            printf("Failed to open file %s\n", file_name.c_str());
+            return std::nullopt;
+        }
+        const size_t file_size = input.tellg();
+        input.seekg(0, std::ios::beg);
+
+        std::vector<Snapshot> snapshots;
+        if (is_binary_recording(file_name))
+        {
+            Header header;
+            input.read(reinterpret_cast<char *>(&header), sizeof(header));
+            if (auto error = validate(header, file_size); error.has_value())
+            {
+                printf("Invalid recording %s: %s\n", file_name.c_str(), error->c_str());
+                return std::nullopt;
+            }
+            // the frames column is contiguous right after the header
+            snapshots.resize(header.frame_count);
+            input.read(reinterpret_cast<char *>(snapshots.data()), snapshots.size() * sizeof(FrameRecord));
+            return snapshots;
+        }
+
+        std::string line;
+        uint64_t line_number = 0;
+        while (std::getline(input, line))
+        {
+            line_number++;
+            if (line.empty())
+            {
+                continue;
+            }
+
+            auto snapshot = parse_snapshot(line);
+            if (!snapshot.has_value())
+            {
+                printf("%s:%llu: %s\n", file_name.c_str(), static_cast<unsigned long long>(line_number), to_string(snapshot.error()));
+                return std::nullopt;
+            }
+            snapshots.push_back(snapshot.value());
+        }
+        return snapshots;
+    }
+};
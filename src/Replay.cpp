@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include "LinAlgPointMapping.h"
+#include "PointMapping.h"
+#include "Recording.h"
+#include "Replay.h"
+#include "WorkStealingPool.h"
+
+namespace Replay {
+    struct StrategyOutput
+    {
+        std::vector<PointF> cursors;
+        std::vector<uint8_t> valid;
+    };
+
+    // the state of one recording, shared by its load task and chunk tasks
+    struct RecordingJob
+    {
+        std::string input_path;
+        std::filesystem::path output_path;
+        std::vector<Snapshot> snapshots;
+        StrategyOutput euclidean;
+        StrategyOutput perspective;
+        std::atomic<size_t> remaining_chunks{0};
+    };
+
+    struct Counters
+    {
+        std::atomic<uint64_t> failed_recordings{0};
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> mapped{0};
+        std::atomic<uint64_t> chunks{0};
+    };
+
+    static bool uses_euclidean(Strategy strategy)
+    {
+        return strategy == Strategy::Euclidean || strategy == Strategy::Both;
+    }
+
+    static bool uses_perspective(Strategy strategy)
+    {
+        return strategy == Strategy::Perspective || strategy == Strategy::Both;
+    }
+
+    static uint64_t map_chunk(RecordingJob &job, size_t begin, size_t end, const Options &options)
+    {
+        uint64_t mapped = 0;
+        if (uses_euclidean(options.strategy))
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                auto cursor = map_snapshot_to_cursor(job.snapshots[i], options.screen);
+                job.euclidean.valid[i] = cursor.has_value();
+                if (cursor.has_value())
+                {
+                    job.euclidean.cursors[i] = cursor.value();
+                    mapped++;
+                }
+            }
+        }
+        if (uses_perspective(options.strategy))
+        {
+            // each chunk is a contiguous range, so the batched lanes can run over it directly
+            std::span<const Snapshot> snapshots(job.snapshots.data() + begin, end - begin);
+            std::span<PointF> cursors(job.perspective.cursors.data() + begin, end - begin);
+            std::span<uint8_t> valid(job.perspective.valid.data() + begin, end - begin);
+            LinAlgPointMapping::map_snapshots_to_cursors(snapshots, options.screen, cursors, valid);
+            mapped += std::ranges::count(valid, 1);
+        }
+        return mapped;
+    }
+
+    static bool write_cursors(const RecordingJob &job, const Options &options)
+    {
+        std::string text = "frame";
+        if (uses_euclidean(options.strategy))
+        {
+            text += ",euclidean_x,euclidean_y";
+        }
+        if (uses_perspective(options.strategy))
+        {
+            text += ",perspective_x,perspective_y";
+        }
+        text += '\n';
+
+        auto out = std::back_inserter(text);
+        auto format_cursor = [&out](const StrategyOutput &output, size_t i) {
+            if (output.valid[i])
+            {
+                std::format_to(out, ",{:.3f},{:.3f}", output.cursors[i].x, output.cursors[i].y);
+            }
+            else
+            {
+                std::format_to(out, ",,");
+            }
+        };
+        for (size_t i = 0; i < job.snapshots.size(); i++)
+        {
+            std::format_to(out, "{}", i);
+            if (uses_euclidean(options.strategy))
+            {
+                format_cursor(job.euclidean, i);
+            }
+            if (uses_perspective(options.strategy))
+            {
+                format_cursor(job.perspective, i);
+            }
+            text += '\n';
+        }
+
+        std::ofstream output(job.output_path, std::ios::binary | std::ios::trunc);
+        output.write(text.data(), text.size());
+        if (!output)
+        {
+            printf("Failed to write %s\n", job.output_path.string().c_str());
+            return false;
+        }
+        return true;
+    }
+
+    static void finish(RecordingJob &job, const Options &options, Counters &counters)
+    {
+        if (!write_cursors(job, options))
+        {
+            counters.failed_recordings++;
+        }
+        // release the recording as soon as it's written, many recordings may be in flight
+        job.snapshots = {};
+        job.euclidean = {};
+        job.perspective = {};
+    }
+
+    static void load(WorkStealingPool &pool, RecordingJob &job, const Options &options, Counters &counters)
+    {
+        auto snapshots = Recording::load_snapshots(job.input_path);
+        if (!snapshots.has_value())
+        {
+            counters.failed_recordings++;
+            return;
+        }
+        job.snapshots = std::move(snapshots.value());
+        counters.frames += job.snapshots.size();
+
+        auto allocate = [&job](StrategyOutput &output) {
+            output.cursors.resize(job.snapshots.size());
+            output.valid.resize(job.snapshots.size());
+        };
+        if (uses_euclidean(options.strategy))
+        {
+            allocate(job.euclidean);
+        }
+        if (uses_perspective(options.strategy))
+        {
+            allocate(job.perspective);
+        }
+
+        const size_t chunk_count = (job.snapshots.size() + options.chunk_frames - 1) / options.chunk_frames;
+        if (chunk_count == 0)
+        {
+            finish(job, options, counters);
+            return;
+        }
+
+        // the chunks go on this worker's deque, idle workers steal them
+        job.remaining_chunks = chunk_count;
+        counters.chunks += chunk_count;
+        for (size_t chunk = 0; chunk < chunk_count; chunk++)
+        {
+            size_t begin = chunk * options.chunk_frames;
+            size_t end = std::min(begin + options.chunk_frames, job.snapshots.size());
+            pool.spawn([&job, begin, end, &options, &counters]() {
+                counters.mapped += map_chunk(job, begin, end, options);
+                // the last chunk to finish writes the whole stream in order
+                if (--job.remaining_chunks == 0)
+                {
+                    finish(job, options, counters);
+                }
+            });
+        }
+    }
+
+    Report run(const Options &options)
+    {
+        std::vector<std::unique_ptr<RecordingJob>> jobs;
+        for (const auto &recording : options.recordings)
+        {
+            auto job = std::make_unique<RecordingJob>();
+            job->input_path = recording;
+            job->output_path = std::filesystem::path(options.output_directory) /
+                               (std::filesystem::path(recording).stem().string() + ".cursors.csv");
+            jobs.push_back(std::move(job));
+        }
+
+        // the streams are named after the recording's stem, recordings of the same name would overwrite each other
+        std::map<std::filesystem::path, std::string> outputs;
+        uint64_t duplicates = 0;
+        for (const auto &job : jobs)
+        {
+            auto [first, inserted] = outputs.try_emplace(job->output_path, job->input_path);
+            if (!inserted)
+            {
+                printf("Error: %s and %s both write %s\n", first->second.c_str(), job->input_path.c_str(), job->output_path.c_str());
+                duplicates++;
+            }
+        }
+        if (duplicates > 0)
+        {
+            Report report;
+            report.recordings = jobs.size();
+            report.failed_recordings = duplicates;
+            return report;
+        }
+
+        WorkStealingPool pool(options.threads);
+        Counters counters;
+        std::vector<WorkStealingPool::Task> tasks;
+        for (auto &job : jobs)
+        {
+            tasks.push_back([&pool, &job = *job, &options, &counters]() { load(pool, job, options, counters); });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        pool.run(std::move(tasks));
+        auto wall_time = std::chrono::steady_clock::now() - start;
+
+        Report report;
+        report.recordings = jobs.size();
+        report.failed_recordings = counters.failed_recordings;
+        report.frames = counters.frames;
+        report.mapped = counters.mapped;
+        report.chunks = counters.chunks;
+        report.threads = pool.thread_count();
+        report.wall_seconds = std::chrono::duration<double>(wall_time).count();
+        for (const auto &stats : pool.stats())
+        {
+            report.stolen += stats.stolen;
+            report.busy_seconds += std::chrono::duration<double>(stats.busy).count();
+        }
+        return report;
+    }
+
+    double Report::frames_per_second() const
+    {
+        return wall_seconds > 0 ? frames / wall_seconds : 0;
+    }
+
+    double Report::frames_per_second_per_core() const
+    {
+        return threads > 0 ? frames_per_second() / threads : 0;
+    }
+
+    std::string Report::to_string() const
+    {
+        return std::format("recordings: {} ({} failed), frames: {}, mapped: {}, chunks: {}, stolen: {}, threads: {}, "
+                           "wall time: {:.3f} s, busy: {:.0f}%, {:.0f} frames/s, {:.0f} frames/s per core",
+            recordings, failed_recordings, frames, mapped, chunks, stolen, threads,
+            wall_seconds, wall_seconds > 0 ? 100 * busy_seconds / (wall_seconds * threads) : 0,
+            frames_per_second(), frames_per_second_per_core());
+    }
+};
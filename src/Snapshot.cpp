@@ -1,15 +1,22 @@
+#include <charconv>
+#include <format>
 #include "Snapshot.h"
+#include "Trace.h"
 
 std::string Point::to_string() const
 {
     return "(" + std::to_string(x) + "," + std::to_string(y) + ")";
 }
 
-std::string PointF::to_string() const
+template <typename T>
+std::string BasicPoint<T>::to_string() const
 {
-    return "(" + std::to_string(x) + "," + std::to_string(y) + ")";
+    return "(" + std::to_string(static_cast<double>(x)) + "," + std::to_string(static_cast<double>(y)) + ")";
 }
 
+template struct BasicPoint<float>;
+template struct BasicPoint<double>;
+
 Point point_from_string(const std::string &str)
 {
     Point p;
@@ -21,14 +28,8 @@ Point point_from_string(const std::string &str)
 
 std::string Snapshot::to_string() const
 {
-    std::string str = "[";
-    for (const auto &point : points)
-    {
-        str += point.to_string() + ",";
-    }
-    str.pop_back(); // remove the last comma
-    str += "]";
-    return str;
+    SnapshotTextBuffer buffer;
+    return std::string(format_snapshot(*this, buffer));
 }
 
 bool Snapshot::is_valid() const
@@ -43,28 +44,123 @@ bool Snapshot::is_valid() const
     return true;
 }
 
-Snapshot snapshot_from_string(const std::string &input)
+namespace
 {
+    // a cursor over the input, every call consumes the leading whitespace first
+    class SnapshotParser
+    {
+    public:
+        explicit SnapshotParser(std::string_view input) : it(input.data()), end(input.data() + input.size()) {}
+
+        bool expect(char c)
+        {
+            skip_whitespace();
+            if (it == end || *it != c)
+            {
+                return false;
+            }
+            it++;
+            return true;
+        }
+
+        bool number(uint16_t &value)
+        {
+            skip_whitespace();
+            auto [ptr, ec] = std::from_chars(it, end, value);
+            if (ec != std::errc())
+            {
+                return false;
+            }
+            it = ptr;
+            return true;
+        }
+
+        bool at_end()
+        {
+            skip_whitespace();
+            return it == end;
+        }
+
+    private:
+        void skip_whitespace()
+        {
+            while (it != end && (*it == ' ' || *it == '\t' || *it == '\r' || *it == '\n'))
+            {
+                it++;
+            }
+        }
+
+        const char *it;
+        const char *end;
+    };
+}
+
+std::expected<Snapshot, ParseError> parse_snapshot(std::string_view input)
+{
+    TRACE_SPAN("parse_snapshot");
+
     Snapshot result;
+    SnapshotParser parser(input);
 
-    // Remove leading and trailing '[' and ']'
-    std::string data = input.substr(1, input.size() - 2);
+    if (!parser.expect('['))
+    {
+        return std::unexpected(ParseError::UnexpectedCharacter);
+    }
 
-    std::stringstream ss(data);
-    char discard;
-    for (int i = 0; i < 4; ++i)
+    for (size_t i = 0; i < result.points.size(); i++)
     {
-        ss >> discard; // discard '('
-        ss >> result.points[i].x;
-        ss >> discard; // discard ','
-        ss >> result.points[i].y;
-        ss >> discard; // discard ')'
-        ss >> discard; // discard ','
+        if (i > 0 && !parser.expect(','))
+        {
+            return std::unexpected(ParseError::UnexpectedCharacter);
+        }
+        if (!parser.expect('('))
+        {
+            return std::unexpected(ParseError::UnexpectedCharacter);
+        }
+        if (!parser.number(result.points[i].x))
+        {
+            return std::unexpected(ParseError::InvalidNumber);
+        }
+        if (!parser.expect(','))
+        {
+            return std::unexpected(ParseError::UnexpectedCharacter);
+        }
+        if (!parser.number(result.points[i].y))
+        {
+            return std::unexpected(ParseError::InvalidNumber);
+        }
+        if (!parser.expect(')'))
+        {
+            return std::unexpected(ParseError::UnexpectedCharacter);
+        }
+    }
+
+    if (!parser.expect(']'))
+    {
+        return std::unexpected(ParseError::UnexpectedCharacter);
+    }
+    if (!parser.at_end())
+    {
+        return std::unexpected(ParseError::TrailingCharacters);
     }
 
     return result;
 }
 
+Snapshot snapshot_from_string(const std::string &input)
+{
+    return parse_snapshot(input).value_or(Snapshot::invalid());
+}
+
+std::string_view format_snapshot(const Snapshot &snapshot, SnapshotTextBuffer &buffer)
+{
+    const auto &[p0, p1, p2, p3] = snapshot.points;
+    // the buffer fits the longest possible text, so the output is never truncated
+    auto result = std::format_to_n(buffer.data(), buffer.size(), "[({},{}),({},{}),({},{}),({},{})]",
+        p0.x, p0.y, p1.x, p1.y, p2.x, p2.y, p3.x, p3.y);
+    return std::string_view(buffer.data(), result.out);
+}
+
 Snapshot Snapshot::invalid()
 {
     return {Point{1023, 1023}, Point{1023, 1023}, Point{1023, 1023}, Point{1023, 1023}};
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <signal.h>
+#include <thread>
+#include <vector>
+#include "Trace.h"
+
+namespace
+{
+    struct Event
+    {
+        std::atomic<const char *> name{nullptr};
+        std::atomic<int64_t> begin_ns{0};
+        std::atomic<int64_t> end_ns{0};
+    };
+
+    /*
+    a single writer ring: the owning thread bumps `started` before it overwrites a slot and `written` after.
+    a reader copies the slots up to `written` and then reloads `started`, every slot the writer may have
+    overwritten meanwhile (the last `started` minus the capacity and older) is discarded. all accesses are
+    atomic, the relaxed ones are ordered by the fences, like a seqlock
+    */
+    struct ThreadRing
+    {
+        uint32_t tid = 0;
+        std::atomic<const char *> name{nullptr};
+        std::atomic<uint64_t> started{0};
+        std::atomic<uint64_t> written{0};
+        std::array<Event, Trace::ring_capacity> events;
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadRing>> rings; // never shrinks, the spans of finished threads stay in the trace
+    };
+
+    // leaked, threads may still record while the statics are destroyed at exit
+    Registry &registry()
+    {
+        static auto *instance = new Registry;
+        return *instance;
+    }
+
+    ThreadRing &thread_ring()
+    {
+        thread_local ThreadRing *ring = nullptr;
+        if (ring == nullptr)
+        {
+            auto &reg = registry();
+            std::lock_guard lock(reg.mutex);
+            reg.rings.push_back(std::make_unique<ThreadRing>());
+            ring = reg.rings.back().get();
+            ring->tid = static_cast<uint32_t>(reg.rings.size());
+        }
+        return *ring;
+    }
+
+    int64_t to_ns(Trace::clock::time_point time)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+
+    std::string &dump_path()
+    {
+        static std::string path;
+        return path;
+    }
+}
+
+namespace Trace {
+    void record(const char *name, clock::time_point begin, clock::time_point end)
+    {
+        auto &ring = thread_ring();
+        const uint64_t index = ring.written.load(std::memory_order_relaxed);
+        ring.started.store(index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto &event = ring.events[index % ring_capacity];
+        event.name.store(name, std::memory_order_relaxed);
+        event.begin_ns.store(to_ns(begin), std::memory_order_relaxed);
+        event.end_ns.store(to_ns(end), std::memory_order_relaxed);
+        ring.written.store(index + 1, std::memory_order_release);
+    }
+
+    void set_thread_name(const char *name)
+    {
+        if constexpr (enabled)
+        {
+            thread_ring().name.store(name, std::memory_order_relaxed);
+        }
+    }
+
+    bool write_chrome_trace(const std::string &path)
+    {
+        struct Copy
+        {
+            const char *name;
+            int64_t begin_ns;
+            int64_t end_ns;
+        };
+
+        std::string json = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+        bool first = true;
+        auto append = [&json, &first](const std::string &event) {
+            json += first ? "\n" : ",\n";
+            json += event;
+            first = false;
+        };
+
+        auto &reg = registry();
+        std::lock_guard lock(reg.mutex);
+        std::vector<Copy> copies;
+        for (const auto &ring : reg.rings)
+        {
+            const uint64_t end = ring->written.load(std::memory_order_acquire);
+            const uint64_t begin = end > ring_capacity ? end - ring_capacity : 0;
+            copies.clear();
+            for (uint64_t index = begin; index < end; index++)
+            {
+                const auto &event = ring->events[index % ring_capacity];
+                copies.push_back({event.name.load(std::memory_order_relaxed), event.begin_ns.load(std::memory_order_relaxed),
+                                  event.end_ns.load(std::memory_order_relaxed)});
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t started = ring->started.load(std::memory_order_relaxed);
+            const uint64_t overwritten = started > ring_capacity ? started - ring_capacity : 0;
+
+            if (const char *name = ring->name.load(std::memory_order_relaxed); name != nullptr)
+            {
+                append(std::format("{{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": {}, \"args\": {{\"name\": \"{}\"}}}}",
+                    ring->tid, name));
+            }
+            for (uint64_t index = std::max(begin, overwritten); index < end; index++)
+            {
+                const auto &copy = copies[index - begin];
+                append(std::format("{{\"name\": \"{}\", \"ph\": \"X\", \"ts\": {:.3f}, \"dur\": {:.3f}, \"pid\": 1, \"tid\": {}}}",
+                    copy.name, copy.begin_ns / 1000.0, (copy.end_ns - copy.begin_ns) / 1000.0, ring->tid));
+            }
+        }
+        json += "\n]}\n";
+
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        if (!output.is_open())
+        {
+            printf("Error: failed to open %s for writing\n", path.c_str());
+            return false;
+        }
+        output << json;
+        return output.good();
+    }
+
+    void dump_on_exit_and_signal(const std::string &path)
+    {
+        dump_path() = path;
+        std::atexit([]() { write_chrome_trace(dump_path()); });
+
+        // a thread waits for the signal instead of a handler, writing the trace isn't async-signal-safe
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGUSR1);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+        std::thread([signals]() {
+            while (true)
+            {
+                int signal = 0;
+                if (sigwait(&signals, &signal) == 0 && write_chrome_trace(dump_path()))
+                {
+                    printf("Trace: wrote %s\n", dump_path().c_str());
+                }
+            }
+        }).detach();
+    }
+};
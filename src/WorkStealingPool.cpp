@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <thread>
+#include "WorkStealingPool.h"
+
+namespace
+{
+    // the index of the worker running on this thread, for `spawn()`
+    thread_local size_t current_worker = 0;
+}
+
+WorkStealingPool::WorkStealingPool(size_t thread_count)
+    : worker_stats(std::max<size_t>(thread_count, 1))
+{
+    for (size_t i = 0; i < worker_stats.size(); i++)
+    {
+        workers.push_back(std::make_unique<Worker>());
+    }
+}
+
+size_t WorkStealingPool::thread_count() const
+{
+    return workers.size();
+}
+
+const std::vector<WorkStealingPool::WorkerStats> &WorkStealingPool::stats() const
+{
+    return worker_stats;
+}
+
+void WorkStealingPool::run(std::vector<Task> tasks)
+{
+    // deal the initial tasks round robin, stealing evens out the rest
+    pending += tasks.size();
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+        workers[i % workers.size()]->tasks.push_back(std::move(tasks[i]));
+    }
+
+    std::vector<std::jthread> threads;
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        threads.emplace_back([this, i]() { work(i); });
+    }
+}
+
+void WorkStealingPool::spawn(Task task)
+{
+    pending++;
+    auto &worker = *workers[current_worker];
+    {
+        std::lock_guard lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    // one parked worker is enough to steal it
+    queued.fetch_add(1);
+    queued.notify_one();
+}
+
+bool WorkStealingPool::pop(size_t index, Task &task)
+{
+    auto &worker = *workers[index];
+    std::lock_guard lock(worker.mutex);
+    if (worker.tasks.empty())
+    {
+        return false;
+    }
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t index, Task &task)
+{
+    for (size_t offset = 1; offset < workers.size(); offset++)
+    {
+        auto &victim = *workers[(index + offset) % workers.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::work(size_t index)
+{
+    current_worker = index;
+    auto &stats = worker_stats[index];
+    Task task;
+    while (true)
+    {
+        // read before looking for work, a task queued or finished after this wakes the wait below
+        const auto seen = queued.load();
+        // a running task may still spawn more, so only stop once nothing is queued or running
+        if (pending.load() == 0)
+        {
+            break;
+        }
+
+        bool stolen = false;
+        if (!pop(index, task))
+        {
+            stolen = steal(index, task);
+            if (!stolen)
+            {
+                queued.wait(seen);
+                continue;
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        task();
+        stats.busy += std::chrono::steady_clock::now() - start;
+        stats.executed++;
+        stats.stolen += stolen;
+        task = nullptr;
+        if (--pending == 0)
+        {
+            // the parked workers can stop
+            queued.fetch_add(1);
+            queued.notify_all();
+        }
+    }
+}
@@ -2,11 +2,19 @@
 #include <cstdio>
 #include <cmath>
 #include <fstream>
+#include <filesystem>
 #include <iostream>
 #include <tuple>
 #include <optional>
 #include <cstdlib>
 #include <format>
+#include <vector>
+#include <map>
+#include <memory>
+#include <array>
+#include <algorithm>
+#include <span>
+#include <type_traits>
 
 #include <SDL2/SDL.h>
 #include <CLI/CLI.hpp>
@@ -17,7 +25,19 @@
 #include "consts.h"
 #include "PointMapping.h"
 #include "DataAcqPlayback.h"
+#include "DataAcqMappedPlayback.h"
+#include "DataAcqUDP.h"
+#include "Recording.h"
+#include "FramePacer.h"
+#include "FrameStats.h"
+#include "GunSet.h"
+#include "AsyncGunSet.h"
+#include "EventLoop.h"
+#include "CursorPredictor.h"
+#include "Replay.h"
 #include "LinAlgPointMapping.h"
+#include "Trace.h"
+#include "LiveStats.h"
 
 std::pair<SDL_FPoint, SDL_FPoint> sdl_segment(const LineSegment &segment)
 {
@@ -39,92 +59,369 @@ SDL_FPoint sdl_point(const Point &point)
     return {static_cast<float>(point.x), static_cast<float>(point.y)};
 }
 
-// record raw data from the HTTP server
-void record(IDataAcq *data_acq, std::string file_name, uint32_t samples, uint8_t fps)
+// record raw data from the HTTP server, as a binary recording with capture timestamps
+void record(IDataAcq *data_acq, std::string file_name, uint32_t samples, uint32_t fps)
 {
-    std::ofstream output(file_name, std::ios::out);
+    Recording::Writer output(file_name, fps, true);
     if (!output.is_open())
     {
-        printf("Failed to open file %s\n", file_name.c_str());
         return;
     }
 
+    FramePacer pacer(std::chrono::nanoseconds(std::chrono::seconds(1)) / fps);
+    SnapshotTextBuffer buffer;
+    std::optional<FramePacer::clock::time_point> first_deadline;
     while (samples-- > 0)
     {
+        // stamped with the deadline the request was issued at, the time `get()` took is latency, not capture time
+        auto deadline = pacer.wait_next();
         auto snapshot = data_acq->get();
-        output << snapshot.to_string() << std::endl;
-        std::cout << snapshot.to_string() << std::endl;
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000 / fps));
+        first_deadline = first_deadline.value_or(deadline);
+        auto capture_time = std::chrono::duration_cast<std::chrono::microseconds>(deadline - first_deadline.value());
+        if (!output.write(snapshot, capture_time.count()))
+        {
+            break;
+        }
+        std::cout << format_snapshot(snapshot, buffer) << '\n';
     }
 
-    output.close();
+    if (!output.close())
+    {
+        printf("Failed to write %s, the recording is incomplete\n", file_name.c_str());
+    }
+    printf("Recording: %s\n", pacer.stats().to_string().c_str());
 }
 
-void play(IDataAcq *data_acq, Screen *screen, screen_constants constants, const bool debug_mode)
+// whether `draw_frame` has anything to draw for the frame
+bool drawable(const MappedFrame &frame, const bool debug_mode)
 {
-    const ScreenCorners screen_corners{
-        PointF{0, 0},
-        PointF{constants.effective_width, 0},
-        PointF{0, constants.effective_height},
-        PointF{constants.effective_width, constants.effective_height}
-    };
+    return debug_mode ? frame.debug_borders.has_value() : frame.cursor.has_value();
+}
 
-    while (true)
+// queue a mapped frame in the gun's color, the caller clears the screen's pixels and segments first
+void draw_frame(Screen *screen, const MappedFrame &frame, const bool debug_mode, SDL_Color color)
+{
+    if (debug_mode)
     {
-        auto snapshot = data_acq->get();
+        if (!frame.debug_borders.has_value())
+        {
+            return;
+        }
+        const auto &borders = frame.debug_borders.value();
+        auto corners = borders.corners;
 
-        if (debug_mode)
+        for (auto &point : frame.snapshot.points)
         {
-            printf("Snapshot: %s\n", snapshot.to_string().c_str());
+            screen->add_pixel(sdl_point(point), color);
+        }
+        auto& top_left = corners.top_left;
+        auto& top_right = corners.top_right;
+        auto& bot_left = corners.bot_left;
+        auto& bot_right = corners.bot_right;
+
+        screen->add_pixel(sdl_point(top_left), color);
+        screen->add_pixel(sdl_point(top_right), color);
+        screen->add_pixel(sdl_point(bot_left), color);
+        screen->add_pixel(sdl_point(bot_right), color);
+
+        screen->add_segment(sdl_segment(borders.screen_top_segment), color);
+        screen->add_segment(sdl_segment(borders.screen_bot_segment), color);
+        screen->add_segment(sdl_segment(borders.screen_left_segment), color);
+        screen->add_segment(sdl_segment(borders.screen_right_segment), color);
+        screen->add_segment(sdl_segment(borders.cursor_horizontal_segment), color);
+        screen->add_segment(sdl_segment(borders.cursor_vertical_segment), color);
+    }
+    else if (frame.cursor.has_value()) // cursor
+    {
+        const auto &[x, y] = frame.cursor.value();
+        screen->add_pixel({x, y}, color);
+    }
+}
+
+// one color per gun, the first one keeps the single player white
+constexpr std::array<SDL_Color, GunSet::max_guns> gun_colors{{
+    Screen::default_color, {255, 64, 64, 255}, {64, 160, 255, 255}, {255, 220, 0, 255}}};
+
+// the first vertical blank after `now`, with vsync a frame drawn now is presented then
+FrameStats::clock::time_point next_present(FrameStats::clock::time_point last_present, std::chrono::nanoseconds refresh_period,
+                                           FrameStats::clock::time_point now)
+{
+    auto missed = (now - last_present) / refresh_period;
+    return last_present + (std::max<int64_t>(missed, 0) + 1) * refresh_period;
+}
+
+struct PredictionOptions
+{
+    CursorPredictor::Params params;
+    std::chrono::milliseconds display_latency{0}; // from the vertical blank until the cursor is visible
+};
 
-            auto opt_borders = map_snapshot_to_borders(snapshot);
-            if (!opt_borders.has_value())
+// the render loop's state across frames, the same for the guns on threads and on the event loop
+struct RenderState
+{
+    RenderState(Screen *screen, screen_constants constants, bool debug_mode, std::optional<PredictionOptions> prediction,
+                std::span<const LiveStats *const> per_gun)
+        : screen(screen),
+          debug_mode(debug_mode),
+          prediction(prediction),
+          overlay_window(overlay_sources(per_gun))
+    {
+        // with prediction every display frame is drawn, at the cursors extrapolated to the time they will be on screen
+        if (prediction.has_value() && !debug_mode)
+        {
+            for (size_t gun = 0; gun < per_gun.size(); gun++)
             {
-                continue;
+                predictors.emplace_back(prediction->params, PointF{constants.effective_width, constants.effective_height});
             }
-            auto borders = opt_borders.value();
-            auto corners = borders.corners;
+        }
+        const int refresh_rate = screen->refresh_rate() > 0 ? screen->refresh_rate() : 60;
+        refresh_period = std::chrono::nanoseconds(std::chrono::seconds(1)) / refresh_rate;
+    }
 
+    // the overlay sums the render thread's metrics and every gun's
+    std::vector<const LiveStats *> overlay_sources(std::span<const LiveStats *const> per_gun) const
+    {
+        std::vector<const LiveStats *> sources{&live_stats};
+        sources.insert(sources.end(), per_gun.begin(), per_gun.end());
+        return sources;
+    }
+
+    Screen *screen;
+    bool debug_mode;
+    std::optional<PredictionOptions> prediction;
+    std::vector<CursorPredictor> predictors; // one per gun, empty without prediction
+    LiveStats live_stats; // the render thread's metrics, the guns record their own
+    LiveStatsWindow overlay_window;
+    FrameStats frame_stats;
+    std::chrono::nanoseconds refresh_period;
+    FrameStats::clock::time_point last_present = FrameStats::clock::now();
+};
+
+// draw every gun's latest frame and present it, returns false if nothing was drawn
+template <typename Guns>
+bool render_frame(Guns &guns, bool fresh, RenderState &state)
+{
+    Screen *screen = state.screen;
+    bool drawn = false;
+    // guns whose input is on screen in this frame: a fresh frame or a cursor predicted from their input
+    std::array<bool, GunSet::max_guns> contributed{};
+    if (!state.predictors.empty())
+    {
+        auto present_time = next_present(state.last_present, state.refresh_period, FrameStats::clock::now()) + state.prediction->display_latency;
+        screen->clear_pixels();
+        for (size_t gun = 0; gun < guns.size(); gun++)
+        {
+            auto &predictor = state.predictors[gun];
+            const auto &frame = guns.frame(gun);
+            if (guns.fresh(gun) && frame.cursor.has_value())
+            {
+                predictor.add(frame.cursor.value(), frame.capture_time.time_since_epoch());
+            }
+            else if (guns.fresh(gun))
+            {
+                // a lost target stops the cursor instead of extrapolating on
+                predictor.reset();
+            }
+            auto cursor = predictor.predict(present_time.time_since_epoch());
+            if (cursor.has_value())
+            {
+                screen->add_pixel(sdl_point(cursor.value()), gun_colors[gun]);
+                drawn = true;
+            }
+            contributed[gun] = guns.fresh(gun) || cursor.has_value();
+        }
+    }
+    else if (fresh)
+    {
+        // a new frame with nothing to draw keeps the previous image, unless another gun has something new
+        for (size_t gun = 0; gun < guns.size() && !drawn; gun++)
+        {
+            drawn = guns.fresh(gun) && drawable(guns.frame(gun), state.debug_mode);
+        }
+        if (drawn)
+        {
+            // all guns in one pass, one clear and one present
             screen->clear_pixels();
-            for (auto &point : snapshot.points)
+            screen->clear_segments();
+            for (size_t gun = 0; gun < guns.size(); gun++)
             {
-                screen->add_pixel(sdl_point(point));
+                draw_frame(screen, guns.frame(gun), state.debug_mode, gun_colors[gun]);
+                contributed[gun] = guns.fresh(gun);
             }
-            auto& top_left = corners.top_left;
-            auto& top_right = corners.top_right;
-            auto& bot_left = corners.bot_left;
-            auto& bot_right = corners.bot_right;
-
-            screen->add_pixel(sdl_point(top_left));
-            screen->add_pixel(sdl_point(top_right));
-            screen->add_pixel(sdl_point(bot_left));
-            screen->add_pixel(sdl_point(bot_right));
+        }
+    }
 
-            screen->clear_segments();
+    if (state.overlay_window.update(FrameStats::clock::now()))
+    {
+        screen->set_overlay_text(state.overlay_window.text());
+        // the overlay is redrawn once per update even if the frame didn't change
+        drawn = drawn || screen->overlay_visible();
+    }
 
-            screen->add_segment(sdl_segment(borders.screen_top_segment));
-            screen->add_segment(sdl_segment(borders.screen_bot_segment));
-            screen->add_segment(sdl_segment(borders.screen_left_segment));
-            screen->add_segment(sdl_segment(borders.screen_right_segment));
-            screen->add_segment(sdl_segment(borders.cursor_horizontal_segment));
-            screen->add_segment(sdl_segment(borders.cursor_vertical_segment));
+    if (!drawn)
+    {
+        if (!fresh)
+        {
+            // nothing changed, the last presented image is still current
+            state.frame_stats.skipped();
         }
-        else // cursor
+        return false;
+    }
+
+    // blocks until the vertical blank with vsync
+    const auto render_start = FrameStats::clock::now();
+    screen->render_screen();
+    const auto present = FrameStats::clock::now();
+    state.live_stats.render.record(present - render_start);
+    state.live_stats.frame_time.record(present - state.last_present);
+    state.last_present = present;
+
+    // the end to end latency of every gun that contributed, the frame latency of the newest input.
+    // a stale frame redrawn with the overlay isn't a latency sample, it would count its age again every refresh
+    std::optional<FrameStats::clock::time_point> newest_capture;
+    for (size_t gun = 0; gun < guns.size(); gun++)
+    {
+        const auto &frame = guns.frame(gun);
+        if (contributed[gun] && frame.sequence > 0)
         {
-            auto pt = LinAlgPointMapping::map_snapshot_to_cursor(snapshot, screen_corners);
-            if (!pt)
-            {
-                continue;
-            }
-            const auto &[x, y] = pt.value();
+            guns.stats(gun).end_to_end.record(present - frame.capture_time);
+            newest_capture = std::max(newest_capture.value_or(frame.capture_time), frame.capture_time);
+        }
+    }
+    if (newest_capture.has_value())
+    {
+        state.frame_stats.presented(newest_capture.value());
+    }
+    else
+    {
+        state.frame_stats.overlay_refreshed();
+    }
+    return true;
+}
 
-            screen->clear_pixels();
-            screen->add_pixel({x, y});
+template <typename Guns>
+std::vector<const LiveStats *> gun_stats(const Guns &guns)
+{
+    std::vector<const LiveStats *> result;
+    for (size_t gun = 0; gun < guns.size(); gun++)
+    {
+        result.push_back(&guns.stats(gun));
+    }
+    return result;
+}
+
+template <typename Guns>
+void print_summary(const Guns &guns, const RenderState &state)
+{
+    printf("Rendering: %s\n", state.frame_stats.summary().to_string().c_str());
+    printf("Latency: %s\n", state.live_stats.summary().c_str());
+    for (size_t gun = 0; gun < guns.size(); gun++)
+    {
+        printf("Gun %zu latency: %s\n", gun + 1, guns.stats(gun).summary().c_str());
+    }
+}
+
+// the render loop, acquisition and mapping run on their own threads, one pair per gun
+void play(std::span<IDataAcq *const> sources, Screen *screen, screen_constants constants, const GunSet::Params &params,
+          std::optional<PredictionOptions> prediction)
+{
+    GunSet guns(sources, params);
+    RenderState state(screen, constants, params.debug_mode, prediction, gun_stats(guns));
+
+    // while no new frame arrives, block on window events instead of spinning, a short wait keeps the latency low
+    constexpr int idle_wait_ms = 1;
+    int wait_ms = 0;
+    Trace::set_thread_name("render");
+    while (screen->input(wait_ms))
+    {
+        TRACE_SPAN("play");
+        const bool fresh = guns.update();
+        const bool drawn = render_frame(guns, fresh, state);
+        wait_ms = drawn || fresh ? 0 : idle_wait_ms;
+    }
+
+    guns.stop();
+    print_summary(guns, state);
+}
+
+// the render loop as a task next to the guns' tasks, everything on the event loop's thread
+Task<void> render_task(EventLoop &loop, AsyncGunSet &guns, RenderState &state)
+{
+    // SDL has no descriptor to wait on, while no frame arrives its events are polled at this interval
+    constexpr auto input_poll_interval = std::chrono::milliseconds(10);
+    while (state.screen->input(0))
+    {
+        TRACE_SPAN("play");
+        const bool fresh = guns.update();
+        const bool drawn = render_frame(guns, fresh, state);
+
+        // with prediction every display frame is drawn, the present paces the loop like in `play`. without a
+        // present nothing is drawable until a new frame arrives, or for the prediction the next vertical blank
+        const auto now = EventLoop::clock::now();
+        auto deadline = now + input_poll_interval;
+        if (!state.predictors.empty())
+        {
+            deadline = drawn ? now : std::min(deadline, next_present(state.last_present, state.refresh_period, now));
         }
+        co_await guns.frame_ready().wait_until(deadline);
+    }
+    loop.stop();
+}
+
+// the render loop and every gun's acquisition and mapping as tasks on a single event loop
+void play_event_loop(std::span<IAsyncDataAcq *const> sources, Screen *screen, screen_constants constants,
+                     const GunSet::Params &params, std::optional<PredictionOptions> prediction)
+{
+    EventLoop loop;
+    if (!loop.is_open())
+    {
+        return;
+    }
+    AsyncGunSet guns(loop, sources, params);
+    RenderState state(screen, constants, params.debug_mode, prediction, gun_stats(guns));
+    loop.spawn(render_task(loop, guns, state));
+    loop.run();
+
+    print_summary(guns, state);
+    printf("Event loop: %s\n", loop.stats().to_string().c_str());
+}
 
-        screen->render_screen();
-        screen->input();
+// a gun's source, `async_data_acq` is the same object for running it on the event loop
+struct Source
+{
+    IDataAcq *data_acq = nullptr;
+    IAsyncDataAcq *async_data_acq = nullptr;
+    const DataAcqUDP *udp = nullptr; // its stream stats are printed at exit
+};
+
+template <typename T>
+Source open_source(T *source)
+{
+    if (!source->is_open())
+    {
+        delete source;
+        return Source{};
     }
+    Source opened{source, source};
+    if constexpr (std::is_same_v<T, DataAcqUDP>)
+    {
+        opened.udp = source;
+    }
+    return opened;
+}
+
+// a playback source for the recording, without `data_acq` if it can't be opened
+Source open_playback(const std::string &path)
+{
+    // CLI11 asserts that the file exists
+    if (Recording::is_binary_recording(path))
+    {
+        // binary recordings are played at their recorded fps
+        return open_source(new DataAcqMappedPlayback(path));
+    }
+
+    uint8_t fps = 15;
+    return open_source(new DataAcqPlayback(path, fps));
 }
 
 std::tuple<Screen*, screen_constants> init_screen()
@@ -158,90 +455,182 @@ std::tuple<Screen*, screen_constants> init_screen()
     return {screen, constants};
 }
 
-void profile(IDataAcq *data_acq, int32_t profiling_iterations)
-{
-    using MappingStrategy = std::function<std::optional<PointF>(const Snapshot &, const ScreenCorners &)>;
-    MappingStrategy perspective_transform_mapping = LinAlgPointMapping::map_snapshot_to_cursor;
-    MappingStrategy eucalidian_geometry_mapping = map_snapshot_to_cursor;
-    const ScreenCorners fake_screen(1920, 1080);
-    auto profile_strategy = [data_acq, profiling_iterations, fake_screen](std::string name, MappingStrategy map) {
-        auto total_time_us = 0;
-        for (int32_t i = 0; i < profiling_iterations; i++) {
-            auto snapshot = data_acq->get();
-            auto start = std::chrono::steady_clock::now();
-            if (map(snapshot, fake_screen).has_value()) {
-                auto end = std::chrono::steady_clock::now();
-                total_time_us += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-            }
-        }
-        auto output = std::format("Strategy: {}, iterations: {}, total time: {} us, average time: {} us\n",
-            name, profiling_iterations, total_time_us, total_time_us / profiling_iterations);
-        return output;
-    };
-
-    auto eucalidian_output = profile_strategy("Eucalidian Geometry", eucalidian_geometry_mapping);
-    auto perspective_output = profile_strategy("Perspective Transform", perspective_transform_mapping);
-    printf("%s", eucalidian_output.c_str());
-    printf("%s", perspective_output.c_str());
-}
-
 int main(int argc, char** argv)
 {
     // parse CLI arguments
     CLI::App app{"Lightgun Game"};
 
     std::string record_directory;
-    app.add_option("-r,--record", record_directory, "Directory path to record data to (will not record if not specified)")
+    app.add_option("-r,--record", record_directory, "Directory path to record data to, as the binary recording record.lgr with capture timestamps (will not record if not specified)")
         ->check(CLI::ExistingDirectory);
     
-    std::string playback_file_path;
-    app.add_option("-p,--playback", playback_file_path, "File path for playback")
+    std::vector<std::string> playback_file_paths;
+    app.add_option("-p,--playback", playback_file_paths, "File path for playback, one gun per file (up to 4)")
         ->check(CLI::ExistingFile);
 
     bool debug_mode = false;
     app.add_flag("-d,--debug", debug_mode, "Debug rendering mode");
 
-    int32_t profiling_iterations = 0;
-    app.add_option("-t,--time", profiling_iterations, "run time profiling for n iterations (only available in playback mode)")
-        ->check(CLI::Range(1, std::numeric_limits<int32_t>::max()));
+    float reuse_tolerance = 0;
+    app.add_option("--reuse-tolerance", reuse_tolerance, "Reuse the last perspective transform while every IR point moved less than this many camera units (disabled if not specified)")
+        ->check(CLI::Range(0.0f, static_cast<float>(dfrobot_max_unit_x)));
+
+    bool track_partial_visibility = false;
+    app.add_flag("--track-partial", track_partial_visibility, "Keep mapping the cursor while only 2 or 3 IR points are visible, see bench/tracking_bench.cpp");
+
+    std::vector<std::string> convert_paths;
+    app.add_option("-c,--convert", convert_paths, "Convert a text recording to the binary recording format: <text file> <binary file>")
+        ->expected(2);
+
+    std::vector<std::string> esp_addresses{"10.100.102.34:80"};
+    app.add_option("--esp-address", esp_addresses, "Address of the ESP32 HTTP server (e.g. a local stand-in, see tools/esp_http_standin.cpp), one gun per address (up to 4)")
+        ->capture_default_str();
+
+    size_t http_pipeline_depth = 2;
+    app.add_option("--http-pipeline", http_pipeline_depth, "Number of HTTP requests kept in flight")
+        ->check(CLI::Range(1, 16))
+        ->capture_default_str();
+
+    std::vector<uint16_t> udp_ports;
+    app.add_option("--udp-port", udp_ports, "Receive snapshots pushed as UDP datagrams on this port instead of polling HTTP (e.g. from tools/udp_replay_sender.cpp), one gun per port (up to 4)")
+        ->check(CLI::Range(1, 65535));
+
+    CursorFilterConfig filter_config;
+    const std::map<std::string, FilterType> filter_types{
+        {"none", FilterType::None},
+        {"one-euro", FilterType::OneEuro},
+        {"kalman", FilterType::Kalman}};
+    app.add_option("--filter", filter_config.type, "Cursor smoothing: none (default), one-euro or kalman, see bench/filter_bench.cpp for tuning")
+        ->transform(CLI::CheckedTransformer(filter_types, CLI::ignore_case));
+    app.add_option("--one-euro-min-cutoff", filter_config.one_euro.min_cutoff_hz, "One Euro cutoff at rest in Hz, lower is smoother")
+        ->capture_default_str();
+    app.add_option("--one-euro-beta", filter_config.one_euro.beta, "One Euro cutoff increase per px/s, higher is less laggy")
+        ->capture_default_str();
+    app.add_option("--kalman-process-noise", filter_config.kalman.process_noise, "Kalman acceleration noise in px^2/s^3, higher is less laggy")
+        ->capture_default_str();
+    app.add_option("--kalman-measurement-noise", filter_config.kalman.measurement_noise, "Kalman cursor jitter variance in px^2, higher is smoother")
+        ->capture_default_str();
+
+    bool predict = false;
+    app.add_flag("--predict", predict, "Draw the cursor every display frame, extrapolated to the time it is presented (ignored in debug mode)");
+    PredictionOptions prediction_options;
+    app.add_option("--predict-history", prediction_options.params.history, "Measurements in the prediction's velocity fit")
+        ->check(CLI::Range(size_t{2}, CursorPredictor::max_history))
+        ->capture_default_str();
+    uint32_t max_horizon_ms = prediction_options.params.max_horizon.count();
+    app.add_option("--predict-max-horizon-ms", max_horizon_ms, "Never extrapolate further ahead of the newest measurement")
+        ->capture_default_str();
+    app.add_option("--predict-max-step-ratio", prediction_options.params.max_step_ratio, "Never extrapolate further than this times the last measured step")
+        ->capture_default_str();
+    uint32_t display_latency_ms = 0;
+    app.add_option("--predict-display-latency-ms", display_latency_ms, "Additional latency of the display after the vertical blank")
+        ->capture_default_str();
+
+    Replay::Options replay_options;
+    app.add_option("--replay", replay_options.recordings, "Map recordings headless as fast as possible and write their cursor streams as csv")
+        ->check(CLI::ExistingFile);
+    app.add_option("--replay-output", replay_options.output_directory, "Directory for the replay cursor streams")
+        ->check(CLI::ExistingDirectory)
+        ->capture_default_str();
+    const std::map<std::string, Replay::Strategy> replay_strategies{
+        {"euclidean", Replay::Strategy::Euclidean},
+        {"perspective", Replay::Strategy::Perspective},
+        {"both", Replay::Strategy::Both}};
+    replay_options.strategy = Replay::Strategy::Both;
+    app.add_option("--replay-strategy", replay_options.strategy, "Mapping strategy for replay: euclidean, perspective or both (default)")
+        ->transform(CLI::CheckedTransformer(replay_strategies, CLI::ignore_case));
+    replay_options.threads = std::max(1u, std::thread::hardware_concurrency());
+    app.add_option("--replay-threads", replay_options.threads, "Worker threads for replay")
+        ->check(CLI::Range(1, 1024))
+        ->capture_default_str();
+
+    bool event_loop = false;
+    app.add_flag("--event-loop", event_loop, "Run the acquisition, mapping and rendering of every gun as tasks on one epoll event loop instead of 2 threads per gun");
+
+    std::string trace_path;
+    app.add_option("--trace", trace_path, "Write the per-stage spans as Chrome trace JSON to this file on exit and on SIGUSR1 (needs a build with -DLIGHTGUN_TRACING=ON)");
 
     CLI11_PARSE(app, argc, argv);
 
-    if (profiling_iterations > 0 && playback_file_path.length() == 0)
+    if (!trace_path.empty())
     {
-        printf("Time profiling is only supported in playback mode\n");
-        return EXIT_FAILURE;
+        if (!Trace::enabled)
+        {
+            printf("Warning: built without LIGHTGUN_TRACING, %s will have no spans\n", trace_path.c_str());
+        }
+        // before any thread is started, see `dump_on_exit_and_signal`
+        Trace::dump_on_exit_and_signal(trace_path);
     }
 
-    // construct instances
-    IDataAcq *data_acq = nullptr;
-    if (playback_file_path.length() > 0)
+    if (!replay_options.recordings.empty())
+    {
+        auto report = Replay::run(replay_options);
+        printf("Replay: %s\n", report.to_string().c_str());
+        return report.failed_recordings == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (convert_paths.size() == 2)
     {
-        // CLI11 asserts that the file exists
-        uint8_t fps = 15;
-        auto playback_acq = new DataAcqPlayback(playback_file_path, fps);
-        if (!playback_acq->is_open())
+        uint32_t fps = 15;
+        auto frames = Recording::convert_text_recording(convert_paths[0], convert_paths[1], fps);
+        if (!frames.has_value())
         {
             return EXIT_FAILURE;
         }
-        data_acq = playback_acq;
+        printf("Converted %llu frames to %s\n", static_cast<unsigned long long>(frames.value()), convert_paths[1].c_str());
+        return EXIT_SUCCESS;
+    }
+
+    // construct instances, one source per gun
+    std::vector<Source> opened;
+    if (!playback_file_paths.empty())
+    {
+        for (const auto &path : playback_file_paths)
+        {
+            opened.push_back(open_playback(path));
+        }
+    }
+    else if (!udp_ports.empty())
+    {
+        for (uint16_t port : udp_ports)
+        {
+            opened.push_back(open_source(new DataAcqUDP(port)));
+        }
     }
     else
     {
-        data_acq = new DataAcqHTTP("10.100.102.34:80");
+        for (const auto &address : esp_addresses)
+        {
+            auto *http = new DataAcqHTTP(address, http_pipeline_depth);
+            opened.push_back(Source{http, http});
+        }
     }
-
-    if (profiling_iterations)
+    if (std::ranges::any_of(opened, [](const Source &source) { return source.data_acq == nullptr; }))
     {
-        profile(data_acq, profiling_iterations);
+        return EXIT_FAILURE;
     }
-    else if (record_directory.length() > 0)
+    if (opened.empty() || opened.size() > GunSet::max_guns)
+    {
+        printf("Error: %zu sources, between 1 and %zu guns are supported\n", opened.size(), GunSet::max_guns);
+        return EXIT_FAILURE;
+    }
+    std::vector<IDataAcq *> sources;
+    std::vector<IAsyncDataAcq *> async_sources;
+    for (const auto &source : opened)
+    {
+        sources.push_back(source.data_acq);
+        async_sources.push_back(source.async_data_acq);
+    }
+
+    if (record_directory.length() > 0)
     {
         // CLI11 asserts the directory exists
 
         // TODO: recording should be unified with the rendering logic,
         // so they can be used at the same time.
-        record(data_acq, "record.txt", 1200, 60);
+        auto file_name = std::filesystem::path(record_directory) / "record.lgr";
+        // only the first gun is recorded
+        record(sources.front(), file_name.string(), 1200, 60);
     }
     else
     {
@@ -251,7 +640,43 @@ int main(int argc, char** argv)
             return EXIT_FAILURE;
         }
 
-        play(data_acq, screen, constants, debug_mode);
+        std::optional<PredictionOptions> prediction;
+        if (predict)
+        {
+            prediction_options.params.max_horizon = std::chrono::milliseconds(max_horizon_ms);
+            prediction_options.display_latency = std::chrono::milliseconds(display_latency_ms);
+            prediction = prediction_options;
+        }
+
+        GunSet::Params params;
+        params.screen_corners = ScreenCorners{
+            PointF{0, 0},
+            PointF{constants.effective_width, 0},
+            PointF{0, constants.effective_height},
+            PointF{constants.effective_width, constants.effective_height}
+        };
+        params.debug_mode = debug_mode;
+        params.reuse_tolerance = reuse_tolerance;
+        params.filter = filter_config;
+        params.track_partial_visibility = track_partial_visibility;
+
+        if (event_loop)
+        {
+            play_event_loop(async_sources, screen, constants, params, prediction);
+        }
+        else
+        {
+            play(sources, screen, constants, params, prediction);
+        }
+        for (size_t gun = 0; gun < opened.size(); gun++)
+        {
+            if (opened[gun].udp != nullptr)
+            {
+                printf("Gun %zu UDP stream: %s\n", gun + 1, opened[gun].udp->stats().to_string().c_str());
+            }
+        }
+        delete screen;
+        SDL_Quit();
     }
 
     return 0;
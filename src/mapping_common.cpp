@@ -1,120 +1,139 @@
+#include <cmath>
+#include "FixedPoint.h"
 #include "mapping_common.h"
+#include "Trace.h"
 
-namespace 
+template <typename T>
+MappingResult<BasicScreenCorners<T>> classify_ir_corners(const Snapshot &snapshot)
 {
-    ScreenCorners calculate_corners(const Snapshot &snapshot)
+    if (!snapshot.is_valid())
     {
-        if (!snapshot.is_valid())
-        {
-            throw std::runtime_error("Invalid snapshot");
-        }
+        return std::unexpected(MappingError::InvalidSnapshot);
+    }
 
-        PointF avg = {0, 0};
-        for (const auto &tmp : snapshot.points)
-        {
-            avg.x += tmp.x;
-            avg.y += tmp.y;
-        }
-        avg.x /= snapshot.points.size();
-        avg.y /= snapshot.points.size();
+    BasicPoint<T> avg = {T(0), T(0)};
+    for (const auto &tmp : snapshot.points)
+    {
+        avg.x += T(tmp.x);
+        avg.y += T(tmp.y);
+    }
+    avg.x /= T(snapshot.points.size());
+    avg.y /= T(snapshot.points.size());
 
-        // map the snapshot to corners relative to the average point
-        std::optional<PointF> opt_cam_top_left;
-        std::optional<PointF> opt_cam_top_right;
-        std::optional<PointF> opt_cam_bot_left;
-        std::optional<PointF> opt_cam_bot_right;
+    // map the snapshot to corners relative to the average point
+    std::optional<BasicPoint<T>> opt_cam_top_left;
+    std::optional<BasicPoint<T>> opt_cam_top_right;
+    std::optional<BasicPoint<T>> opt_cam_bot_left;
+    std::optional<BasicPoint<T>> opt_cam_bot_right;
 
-        for (const auto &tmp : snapshot.points)
+    for (const auto &tmp : snapshot.points)
+    {
+        BasicPoint<T> point = {T(tmp.x), T(tmp.y)};
+        if (point.x < avg.x && point.y < avg.y)
         {
-            PointF point = {static_cast<float>(tmp.x), static_cast<float>(tmp.y)};
-            if (point.x < avg.x && point.y < avg.y)
-            {
-                opt_cam_top_left = point;
-            }
-            if (point.x > avg.x && point.y < avg.y)
-            {
-                opt_cam_top_right = point;
-            }
-            if (point.x < avg.x && point.y > avg.y)
-            {
-                opt_cam_bot_left = point;
-            }
-            if (point.x > avg.x && point.y > avg.y)
-            {
-                opt_cam_bot_right = point;
-            }
+            opt_cam_top_left = point;
         }
-
-        if (!opt_cam_top_left.has_value() || !opt_cam_top_right.has_value() || !opt_cam_bot_left.has_value() || !opt_cam_bot_right.has_value())
+        if (point.x > avg.x && point.y < avg.y)
         {
-            throw std::runtime_error("Failed to map the snapshot to 4 corners");
+            opt_cam_top_right = point;
         }
-
-        const PointF &cam_top_left = opt_cam_top_left.value();
-        const PointF &cam_top_right = opt_cam_top_right.value();
-        const PointF &cam_bot_left = opt_cam_bot_left.value();
-        const PointF &cam_bot_right = opt_cam_bot_right.value();
-
-        // now that we have the 4 points mapped, we can create 2 horizontal line equations
-        // we know that the length between 2 horizontal pairs is constant (the WII IR Sensor Bar size)
-        auto opt_top_line = Line::from_points(cam_top_left, cam_top_right);
-        auto opt_bot_line = Line::from_points(cam_bot_left, cam_bot_right);
-        if (!opt_top_line.has_value() || !opt_bot_line.has_value())
+        if (point.x < avg.x && point.y > avg.y)
         {
-            throw std::runtime_error("Failed to create the 2 horizontal lines");
+            opt_cam_bot_left = point;
         }
-
-        const Line &top_line = opt_top_line.value();
-        const Line &bot_line = opt_bot_line.value();
-
-        // get the average point of the 2 horizontal pairs
-        // this is the horizontal center of the screen relative to the IR camera
-        PointF top_avg = {float(cam_top_left.x + cam_top_right.x) / 2, float(cam_top_left.y + cam_top_right.y) / 2};
-        PointF bot_avg = {float(cam_bot_left.x + cam_bot_right.x) / 2, float(cam_bot_left.y + cam_bot_right.y) / 2};
-
-        // the distance between any average point and a point on the same horizontal line is half the width of the WII IR Sensor Bar
-        // we cross multiply to get the step width and calculate the screen corner points
-        float ratio_top = (cam_top_right.x - top_avg.x) / (wii_ir_led_width_cm / 2);
-        float ratio_bot = (cam_bot_right.x - bot_avg.x) / (wii_ir_led_width_cm / 2);
-
-        constexpr float screen_half_width_cm = screen_width_cm / 2;
-        float x_diff_top = std::abs(screen_half_width_cm * ratio_top);
-        float x_diff_bot = std::abs(screen_half_width_cm * ratio_bot);
-
-        // now that we have the step width, we can calculate the screen end points
-        float x_top_left = top_avg.x - x_diff_top;
-        float x_top_right = top_avg.x + x_diff_top;
-        float x_bot_left = bot_avg.x - x_diff_bot;
-        float x_bot_right = bot_avg.x + x_diff_bot;
-
-        std::optional<float> opt_y_top_left = top_line.y(x_top_left);
-        std::optional<float> opt_y_top_right = top_line.y(x_top_right);
-        std::optional<float> opt_y_bot_left = bot_line.y(x_bot_left);
-        std::optional<float> opt_y_bot_right = bot_line.y(x_bot_right);
-
-        if (!opt_y_top_left.has_value() || !opt_y_top_right.has_value() || !opt_y_bot_left.has_value() || !opt_y_bot_right.has_value())
+        if (point.x > avg.x && point.y > avg.y)
         {
-            throw std::runtime_error("Failed to calculate the screen end points");
+            opt_cam_bot_right = point;
         }
+    }
 
-        PointF screen_top_left = {x_top_left, opt_y_top_left.value()};
-        PointF screen_top_right = {x_top_right, opt_y_top_right.value()};
-        PointF screen_bot_left = {x_bot_left, opt_y_bot_left.value()};
-        PointF screen_bot_right = {x_bot_right, opt_y_bot_right.value()};
-
-        return ScreenCorners(screen_top_left, screen_top_right, screen_bot_left, screen_bot_right);
+    if (!opt_cam_top_left.has_value() || !opt_cam_top_right.has_value() || !opt_cam_bot_left.has_value() || !opt_cam_bot_right.has_value())
+    {
+        return std::unexpected(MappingError::CornerClassification);
     }
+
+    return BasicScreenCorners<T>(opt_cam_top_left.value(), opt_cam_top_right.value(), opt_cam_bot_left.value(), opt_cam_bot_right.value());
 }
 
-std::optional<ScreenCorners> calculate_screen_corners(const Snapshot &snapshot)
+template <typename T>
+MappingResult<BasicScreenCorners<T>> calculate_screen_corners(const BasicScreenCorners<T> &ir_corners)
 {
-    try
+    TRACE_SPAN("calculate_screen_corners");
+
+    const BasicPoint<T> &cam_top_left = ir_corners.top_left;
+    const BasicPoint<T> &cam_top_right = ir_corners.top_right;
+    const BasicPoint<T> &cam_bot_left = ir_corners.bot_left;
+    const BasicPoint<T> &cam_bot_right = ir_corners.bot_right;
+
+    // now that we have the 4 points mapped, we can create 2 horizontal line equations
+    // we know that the length between 2 horizontal pairs is constant (the WII IR Sensor Bar size)
+    auto opt_top_line = BasicLine<T>::from_points(cam_top_left, cam_top_right);
+    auto opt_bot_line = BasicLine<T>::from_points(cam_bot_left, cam_bot_right);
+    if (!opt_top_line.has_value() || !opt_bot_line.has_value())
+    {
+        return std::unexpected(MappingError::DegenerateLine);
+    }
+
+    const BasicLine<T> &top_line = opt_top_line.value();
+    const BasicLine<T> &bot_line = opt_bot_line.value();
+
+    // get the average point of the 2 horizontal pairs
+    // this is the horizontal center of the screen relative to the IR camera
+    BasicPoint<T> top_avg = {(cam_top_left.x + cam_top_right.x) / T(2), (cam_top_left.y + cam_top_right.y) / T(2)};
+    BasicPoint<T> bot_avg = {(cam_bot_left.x + cam_bot_right.x) / T(2), (cam_bot_left.y + cam_bot_right.y) / T(2)};
+
+    // the distance between any average point and a point on the same horizontal line is half the width of the WII IR Sensor Bar
+    // we cross multiply to get the step width and calculate the screen corner points
+    // (a single constant factor, so a fixed point `T` doesn't lose the precision of a small intermediate ratio)
+    using std::abs;
+    constexpr T screen_per_led_width(screen_width_cm / wii_ir_led_width_cm);
+    T x_diff_top = abs((cam_top_right.x - top_avg.x) * screen_per_led_width);
+    T x_diff_bot = abs((cam_bot_right.x - bot_avg.x) * screen_per_led_width);
+
+    // now that we have the step width, we can calculate the screen end points
+    T x_top_left = top_avg.x - x_diff_top;
+    T x_top_right = top_avg.x + x_diff_top;
+    T x_bot_left = bot_avg.x - x_diff_bot;
+    T x_bot_right = bot_avg.x + x_diff_bot;
+
+    std::optional<T> opt_y_top_left = top_line.y(x_top_left);
+    std::optional<T> opt_y_top_right = top_line.y(x_top_right);
+    std::optional<T> opt_y_bot_left = bot_line.y(x_bot_left);
+    std::optional<T> opt_y_bot_right = bot_line.y(x_bot_right);
+
+    if (!opt_y_top_left.has_value() || !opt_y_top_right.has_value() || !opt_y_bot_left.has_value() || !opt_y_bot_right.has_value())
     {
-        return calculate_corners(snapshot);
+        return std::unexpected(MappingError::VerticalLine);
     }
-    catch (const std::exception &e)
+
+    BasicPoint<T> screen_top_left = {x_top_left, opt_y_top_left.value()};
+    BasicPoint<T> screen_top_right = {x_top_right, opt_y_top_right.value()};
+    BasicPoint<T> screen_bot_left = {x_bot_left, opt_y_bot_left.value()};
+    BasicPoint<T> screen_bot_right = {x_bot_right, opt_y_bot_right.value()};
+
+    return BasicScreenCorners<T>(screen_top_left, screen_top_right, screen_bot_left, screen_bot_right);
+}
+
+template <typename T>
+MappingResult<BasicScreenCorners<T>> calculate_screen_corners(const Snapshot &snapshot)
+{
+    auto ir_corners = classify_ir_corners<T>(snapshot);
+    if (!ir_corners.has_value())
     {
-        fprintf(stderr, "Error: %s\n", e.what());
+        return std::unexpected(ir_corners.error());
     }
-    return std::nullopt;
+    return calculate_screen_corners(ir_corners.value());
 }
+
+// the scalar types the mapping is built for
+template MappingResult<BasicScreenCorners<float>> classify_ir_corners<float>(const Snapshot &snapshot);
+template MappingResult<BasicScreenCorners<float>> calculate_screen_corners<float>(const BasicScreenCorners<float> &ir_corners);
+template MappingResult<BasicScreenCorners<float>> calculate_screen_corners<float>(const Snapshot &snapshot);
+
+template MappingResult<BasicScreenCorners<double>> classify_ir_corners<double>(const Snapshot &snapshot);
+template MappingResult<BasicScreenCorners<double>> calculate_screen_corners<double>(const BasicScreenCorners<double> &ir_corners);
+template MappingResult<BasicScreenCorners<double>> calculate_screen_corners<double>(const Snapshot &snapshot);
+
+// no `Snapshot` overload of `calculate_screen_corners`, see mapping_common.h
+template MappingResult<BasicScreenCorners<Q16>> classify_ir_corners<Q16>(const Snapshot &snapshot);
+template MappingResult<BasicScreenCorners<Q16>> calculate_screen_corners<Q16>(const BasicScreenCorners<Q16> &ir_corners);
@@ -1,16 +1,83 @@
+#include <array>
+#include <cstdint>
 #include "screen.h"
+#include "Trace.h"
 
-Screen::Screen(SDL_Window *window, SDL_Renderer *renderer) : window(window), renderer(renderer)
+namespace
+{
+    constexpr float rect_size = 6.0F;
+
+    // the overlay is drawn as rects, one per lit pixel of a 3x5 font scaled by `overlay_pixel`
+    constexpr SDL_Color overlay_color = {0, 255, 0, 255};
+    constexpr float overlay_pixel = 3.0F;
+    constexpr float overlay_margin = 10.0F;
+    constexpr int glyph_width = 3;
+    constexpr int glyph_height = 5;
+
+    // 5 rows of 3 bits from the top, the highest bit of a row is its left pixel
+    constexpr std::array<uint16_t, 10> digit_glyphs{
+        0b111'101'101'101'111, 0b010'110'010'010'111, 0b111'001'111'100'111, 0b111'001'111'001'111, 0b101'101'111'001'001,
+        0b111'100'111'001'111, 0b111'100'111'101'111, 0b111'001'001'001'001, 0b111'101'111'101'111, 0b111'101'111'001'111};
+    constexpr std::array<uint16_t, 26> letter_glyphs{
+        0b010'101'111'101'101, 0b110'101'110'101'110, 0b011'100'100'100'011, 0b110'101'101'101'110, 0b111'100'110'100'111,
+        0b111'100'110'100'100, 0b011'100'101'101'011, 0b101'101'111'101'101, 0b111'010'010'010'111, 0b001'001'001'101'010,
+        0b101'101'110'101'101, 0b100'100'100'100'111, 0b101'111'111'101'101, 0b110'101'101'101'101, 0b010'101'101'101'010,
+        0b110'101'110'100'100, 0b010'101'101'110'011, 0b110'101'110'101'101, 0b011'100'010'001'110, 0b111'010'010'010'010,
+        0b101'101'101'101'111, 0b101'101'101'101'010, 0b101'101'111'111'101, 0b101'101'010'101'101, 0b101'101'010'010'010,
+        0b111'001'010'100'111};
+
+    bool same_color(SDL_Color lhs, SDL_Color rhs)
+    {
+        return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b && lhs.a == rhs.a;
+    }
+
+    uint16_t glyph(char c)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            return digit_glyphs[c - '0'];
+        }
+        if (c >= 'A' && c <= 'Z')
+        {
+            return letter_glyphs[c - 'A'];
+        }
+        switch (c)
+        {
+        case '.':
+            return 0b000'000'000'000'010;
+        case ':':
+            return 0b000'010'000'010'000;
+        case '/':
+            return 0b001'001'010'100'100;
+        case '-':
+            return 0b000'000'111'000'000;
+        case '%':
+            return 0b101'001'010'100'101;
+        default:
+            return 0;
+        }
+    }
+}
+
+Screen::Screen(SDL_Window *window, SDL_Renderer *renderer, SDL_Surface *surface)
+    : window(window), renderer(renderer), offscreen(surface)
 {
 }
 
 Screen::~Screen()
 {
     SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
+    if (window != nullptr)
+    {
+        SDL_DestroyWindow(window);
+    }
+    if (offscreen != nullptr)
+    {
+        SDL_FreeSurface(offscreen);
+    }
 }
 
-Screen *Screen::create(const char *title, int width, int height, float scale)
+Screen *Screen::create(const char *title, int width, int height, float scale, bool vsync)
 {
     SDL_Init(SDL_INIT_VIDEO);
     SDL_Window *window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_SHOWN);
@@ -19,7 +86,8 @@ Screen *Screen::create(const char *title, int width, int height, float scale)
         return nullptr;
     }
 
-    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    Uint32 renderer_flags = SDL_RENDERER_ACCELERATED | (vsync ? SDL_RENDERER_PRESENTVSYNC : 0);
+    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, renderer_flags);
     if (renderer == nullptr)
     {
         SDL_DestroyWindow(window);
@@ -31,24 +99,94 @@ Screen *Screen::create(const char *title, int width, int height, float scale)
     return new Screen(window, renderer);
 }
 
-void Screen::add_pixel(SDL_FPoint point)
+Screen *Screen::create_headless(int width, int height, float scale)
+{
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA8888);
+    if (surface == nullptr)
+    {
+        return nullptr;
+    }
+
+    SDL_Renderer *renderer = SDL_CreateSoftwareRenderer(surface);
+    if (renderer == nullptr)
+    {
+        SDL_FreeSurface(surface);
+        return nullptr;
+    }
+
+    SDL_RenderSetScale(renderer, scale, scale);
+
+    return new Screen(nullptr, renderer, surface);
+}
+
+int Screen::refresh_rate() const
+{
+    SDL_DisplayMode mode;
+    if (window == nullptr || SDL_GetWindowDisplayMode(window, &mode) != 0)
+    {
+        return 0;
+    }
+    return mode.refresh_rate;
+}
+
+const SDL_Surface *Screen::surface() const
+{
+    return offscreen;
+}
+
+void Screen::add_pixel(SDL_FPoint point, SDL_Color color)
 {
     points.push_back(point);
+    point_colors.push_back(color);
 }
 
-void Screen::add_segment(std::pair<SDL_FPoint, SDL_FPoint> segment)
+void Screen::add_segment(std::pair<SDL_FPoint, SDL_FPoint> segment, SDL_Color color)
 {
     segments.push_back(segment);
+    segment_colors.push_back(color);
 }
 
 void Screen::clear_pixels()
 {
     points.clear();
+    point_colors.clear();
 }
 
 void Screen::clear_segments()
 {
     segments.clear();
+    segment_colors.clear();
+}
+
+void Screen::set_overlay_text(std::string_view text)
+{
+    overlay_rects.clear();
+    int line = 0;
+    int column = 0;
+    for (char c : text)
+    {
+        if (c == '\n')
+        {
+            line++;
+            column = 0;
+            continue;
+        }
+        const uint16_t bits = glyph(c);
+        for (int y = 0; y < glyph_height; y++)
+        {
+            for (int x = 0; x < glyph_width; x++)
+            {
+                if (bits & (1 << ((glyph_height - 1 - y) * glyph_width + (glyph_width - 1 - x))))
+                {
+                    // one blank pixel between columns and lines
+                    overlay_rects.push_back({overlay_margin + ((glyph_width + 1) * column + x) * overlay_pixel,
+                                             overlay_margin + ((glyph_height + 1) * line + y) * overlay_pixel,
+                                             overlay_pixel, overlay_pixel});
+                }
+            }
+        }
+        column++;
+    }
 }
 
 void Screen::clear_screen()
@@ -57,36 +195,83 @@ void Screen::clear_screen()
     SDL_RenderClear(renderer);
 }
 
+void Screen::build_rects()
+{
+    rects.clear();
+    for (const auto &point : points)
+    {
+        rects.push_back({point.x - (rect_size / 2.0F), point.y - (rect_size / 2.0F), rect_size, rect_size});
+    }
+}
+
 void Screen::render_screen()
 {
+    TRACE_SPAN("Screen::render_screen");
+
     clear_screen();
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    //SDL_RenderDrawPointsF(renderer, points.data(), points.size());
-    
-    for (const auto &segment : segments)
+
+    // plain lines, SDL queues them into one batch on the accelerated renderers. thin triangles from
+    // `SDL_RenderGeometry` were 10-100x slower on the software renderer, it scans every triangle's bounding box
+    for (size_t i = 0; i < segments.size(); i++)
     {
-        SDL_RenderDrawLineF(renderer, segment.first.x, segment.first.y, segment.second.x, segment.second.y);
+        const auto &[p1, p2] = segments[i];
+        if (i == 0 || !same_color(segment_colors[i], segment_colors[i - 1]))
+        {
+            const SDL_Color color = segment_colors[i];
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+        }
+        SDL_RenderDrawLineF(renderer, p1.x, p1.y, p2.x, p2.y);
     }
 
-    for (const auto &point : points)
+    if (!points.empty())
+    {
+        build_rects();
+        size_t run_begin = 0;
+        for (size_t i = 1; i <= rects.size(); i++)
+        {
+            if (i < rects.size() && same_color(point_colors[i], point_colors[run_begin]))
+            {
+                continue;
+            }
+            const SDL_Color color = point_colors[run_begin];
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+            SDL_RenderFillRectsF(renderer, rects.data() + run_begin, static_cast<int>(i - run_begin));
+            run_begin = i;
+        }
+    }
+
+    if (show_overlay && !overlay_rects.empty())
     {
-        // create a rectangle and fill it with white color
-        constexpr float rect_size = 6.0F;
-        SDL_FRect rect = {point.x - (rect_size / 2.0F), point.y - (rect_size / 2.0F), rect_size, rect_size};
-        SDL_RenderFillRectF(renderer, &rect);
+        SDL_SetRenderDrawColor(renderer, overlay_color.r, overlay_color.g, overlay_color.b, overlay_color.a);
+        SDL_RenderFillRectsF(renderer, overlay_rects.data(), static_cast<int>(overlay_rects.size()));
     }
 
+    // blocks until the vertical blank with vsync
+    TRACE_SPAN("SDL_RenderPresent");
     SDL_RenderPresent(renderer);
 }
 
-void Screen::input()
+bool Screen::input(int wait_ms)
 {
-    while (SDL_PollEvent(&event))
+    if (window == nullptr)
+    {
+        // headless, there is no window to get events from
+        SDL_Delay(wait_ms);
+        return true;
+    }
+
+    bool has_event = wait_ms > 0 ? SDL_WaitEventTimeout(&event, wait_ms) : SDL_PollEvent(&event);
+    while (has_event)
     {
         if (event.type == SDL_QUIT)
         {
-            SDL_Quit();
-            exit(0);
+            return false;
+        }
+        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F3 && !event.key.repeat)
+        {
+            toggle_overlay();
         }
+        has_event = SDL_PollEvent(&event);
     }
+    return true;
 }
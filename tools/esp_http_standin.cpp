@@ -0,0 +1,160 @@
+// a loopback stand-in for the ESP32 HTTP server, to exercise DataAcqHTTP without the hardware.
+// serves the lines of a text recording, advancing at the camera rate, over keep-alive HTTP/1.1.
+// usage: esp_http_standin raw_data.txt --port 8080 --camera-fps 30 --latency-ms 5
+//        lightgun_game --esp-address 127.0.0.1:8080
+
+#include <CLI/CLI.hpp>
+#include <arpa/inet.h>
+#include <chrono>
+#include <fstream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+
+struct StandinConfig
+{
+    std::vector<std::string> frames;
+    uint32_t camera_fps;
+    std::chrono::milliseconds latency;
+    std::chrono::steady_clock::time_point start;
+};
+
+// the camera's current frame, repeated until the next camera update like the real device
+const std::string &current_frame(const StandinConfig &config)
+{
+    auto elapsed = std::chrono::steady_clock::now() - config.start;
+    auto index = static_cast<size_t>(elapsed * config.camera_fps / std::chrono::seconds(1));
+    return config.frames[index % config.frames.size()];
+}
+
+bool send_all(int fd, const std::string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        auto n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void serve_connection(int fd, const StandinConfig &config)
+{
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    std::string pending;
+    char buffer[4096];
+    while (true)
+    {
+        // a request ends with an empty line, requests without a body are all we expect
+        auto end = pending.find("\r\n\r\n");
+        if (end == std::string::npos)
+        {
+            auto n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0)
+            {
+                break;
+            }
+            pending.append(buffer, static_cast<size_t>(n));
+            continue;
+        }
+        bool close_requested = pending.substr(0, end).find("Connection: close") != std::string::npos;
+        pending.erase(0, end + 4);
+
+        std::this_thread::sleep_for(config.latency);
+        const auto &body = current_frame(config);
+        std::string response = "HTTP/1.1 200 OK\r\n"
+                               "Content-Type: text/plain\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+                               (close_requested ? "Connection: close\r\n" : "Connection: keep-alive\r\n") +
+                               "\r\n" + body;
+        if (!send_all(fd, response) || close_requested)
+        {
+            break;
+        }
+    }
+    close(fd);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CLI::App app{"ESP32 HTTP stand-in"};
+
+    std::string recording_path;
+    app.add_option("recording", recording_path, "Text recording to serve, one snapshot per line")
+        ->required()
+        ->check(CLI::ExistingFile);
+
+    uint16_t port = 8080;
+    app.add_option("--port", port, "Port to listen on (loopback only)")->capture_default_str();
+
+    uint32_t camera_fps = 30;
+    app.add_option("--camera-fps", camera_fps, "Rate at which the served snapshot advances")
+        ->check(CLI::Range(1, 1000))
+        ->capture_default_str();
+
+    uint32_t latency_ms = 0;
+    app.add_option("--latency-ms", latency_ms, "Delay before every response, to simulate the network round trip")
+        ->capture_default_str();
+
+    CLI11_PARSE(app, argc, argv);
+
+    StandinConfig config{{}, camera_fps, std::chrono::milliseconds(latency_ms), std::chrono::steady_clock::now()};
+    std::ifstream input(recording_path);
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (!line.empty())
+        {
+            config.frames.push_back(line);
+        }
+    }
+    if (config.frames.empty())
+    {
+        printf("Error: %s has no snapshots\n", recording_path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (server < 0 || bind(server, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(server, 16) != 0)
+    {
+        perror("Error: failed to listen");
+        return EXIT_FAILURE;
+    }
+
+    printf("Serving %zu snapshots on 127.0.0.1:%u at %u fps\n", config.frames.size(), port, camera_fps);
+    uint64_t connections = 0;
+    while (true)
+    {
+        int client = accept(server, nullptr, nullptr);
+        if (client < 0)
+        {
+            continue;
+        }
+        // one thread per connection, DataAcqHTTP opens one kept-alive connection per pipeline slot
+        printf("Connection %llu opened\n", static_cast<unsigned long long>(++connections));
+        fflush(stdout);
+        std::thread(serve_connection, client, std::cref(config)).detach();
+    }
+}
@@ -0,0 +1,139 @@
+// replays a text recording as UDP snapshot datagrams (see Datagram.h), to exercise DataAcqUDP without an ESP32.
+// loss, reordering and duplication can be simulated to check the receiver's bookkeeping.
+// usage: udp_replay_sender raw_data.txt --port 9000 --fps 60 --loss 0.01 --reorder 0.01
+//        lightgun_game --udp-port 9000
+
+#include <CLI/CLI.hpp>
+#include <arpa/inet.h>
+#include <chrono>
+#include <fstream>
+#include <netinet/in.h>
+#include <optional>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+#include "Datagram.h"
+#include "FramePacer.h"
+#include "Snapshot.h"
+
+int main(int argc, char** argv)
+{
+    CLI::App app{"UDP snapshot replay sender"};
+
+    std::string recording_path;
+    app.add_option("recording", recording_path, "Text recording to replay, one snapshot per line")
+        ->required()
+        ->check(CLI::ExistingFile);
+
+    uint16_t port = 9000;
+    app.add_option("--port", port, "Loopback port DataAcqUDP listens on")->capture_default_str();
+
+    uint32_t fps = 60;
+    app.add_option("--fps", fps, "Datagrams per second")
+        ->check(CLI::Range(1, 100000))
+        ->capture_default_str();
+
+    uint32_t loops = 1;
+    app.add_option("--loops", loops, "Number of passes over the recording, 0 to loop forever")->capture_default_str();
+
+    double loss = 0;
+    app.add_option("--loss", loss, "Probability to drop a datagram")->check(CLI::Range(0.0, 1.0));
+
+    double reorder = 0;
+    app.add_option("--reorder", reorder, "Probability to hold a datagram back and send it after the next one")
+        ->check(CLI::Range(0.0, 1.0));
+
+    double duplicate = 0;
+    app.add_option("--duplicate", duplicate, "Probability to send a datagram twice")->check(CLI::Range(0.0, 1.0));
+
+    CLI11_PARSE(app, argc, argv);
+
+    std::vector<Snapshot> snapshots;
+    std::ifstream input(recording_path);
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (auto snapshot = parse_snapshot(line); snapshot.has_value())
+        {
+            snapshots.push_back(snapshot.value());
+        }
+    }
+    if (snapshots.empty())
+    {
+        printf("Error: %s has no snapshots\n", recording_path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    int socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (socket_fd < 0 || connect(socket_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        perror("Error: failed to open the UDP socket");
+        return EXIT_FAILURE;
+    }
+
+    std::mt19937 rng(std::random_device{}());
+    std::bernoulli_distribution drop_packet(loss);
+    std::bernoulli_distribution hold_packet(reorder);
+    std::bernoulli_distribution duplicate_packet(duplicate);
+
+    uint64_t sent = 0;
+    uint64_t dropped = 0;
+    auto send_packet = [&](const Datagram::Packet &packet) {
+        send(socket_fd, &packet, sizeof(packet), 0);
+        sent++;
+    };
+
+    FramePacer pacer(std::chrono::nanoseconds(std::chrono::seconds(1)) / fps);
+    std::optional<Datagram::Packet> held;
+    uint32_t sequence = 0;
+    for (uint32_t pass = 0; loops == 0 || pass < loops; pass++)
+    {
+        for (const auto &snapshot : snapshots)
+        {
+            pacer.wait_next();
+
+            // stamped with the monotonic clock, like the device's time since boot
+            auto now = std::chrono::steady_clock::now().time_since_epoch();
+            Datagram::Packet packet{Datagram::magic, sequence++,
+                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count()), snapshot};
+
+            if (drop_packet(rng))
+            {
+                dropped++;
+                continue;
+            }
+            if (!held.has_value() && hold_packet(rng))
+            {
+                held = packet;
+                continue;
+            }
+
+            send_packet(packet);
+            if (duplicate_packet(rng))
+            {
+                send_packet(packet);
+            }
+            if (held.has_value())
+            {
+                send_packet(held.value());
+                held.reset();
+            }
+        }
+    }
+    if (held.has_value())
+    {
+        send_packet(held.value());
+    }
+
+    close(socket_fd);
+    printf("Sent %llu datagrams (%u sequence numbers, %llu dropped): %s\n", static_cast<unsigned long long>(sent), sequence,
+           static_cast<unsigned long long>(dropped), pacer.stats().to_string().c_str());
+    return EXIT_SUCCESS;
+}